@@ -0,0 +1,10 @@
+#include "ofApp.h"
+#include "ofAppNoWindow.h"
+
+int main(int argc, char* argv[]) {
+	// The benchmark paints on the CPU, so it doesn't need a window or an OpenGL context
+	ofAppNoWindow window;
+	ofSetupOpenGL(&window, 1024, 768, OF_WINDOW);
+
+	ofRunApp(new ofApp(vector<string>(argv + 1, argv + argc)));
+}
@@ -0,0 +1,454 @@
+#include "ofApp.h"
+#include "ofxOilPaint.h"
+
+#ifdef TARGET_WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+//--------------------------------------------------------------
+ofApp::ofApp(const vector<string>& _arguments) :
+		arguments(_arguments) {
+}
+
+//--------------------------------------------------------------
+void ofApp::setup() {
+	// Only the benchmark report should be printed
+	ofSetLogLevel(OF_LOG_WARNING);
+
+	// Prepare the images to paint
+	parseArguments();
+	createSyntheticImages();
+	loadImages();
+}
+
+//--------------------------------------------------------------
+void ofApp::update() {
+	// Paint every image with every seed
+	auto start = chrono::steady_clock::now();
+
+	for (const BenchmarkImage& image : images) {
+		for (unsigned int seed = 0; seed < nSeeds; ++seed) {
+			runs.push_back(paint(image, seed, seedPrefilter));
+		}
+	}
+
+	totalSeconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+	// Paint the same images without the seed prefilter to compare the paintings. They are not part of the total time.
+	if (seedPrefilter) {
+		for (const BenchmarkImage& image : images) {
+			for (unsigned int seed = 0; seed < nSeeds; ++seed) {
+				referenceRuns.push_back(paint(image, seed, false));
+			}
+		}
+	}
+
+	// Print the report and finish the application, failing if the updates didn't respect their time budget or the
+	// seed prefilter changed the paintings
+	printReport();
+	bool budgetRespected = checkUpdateBudget();
+	bool paintingsKept = checkSeedPrefilter();
+	ofExit(budgetRespected && paintingsKept ? 0 : 1);
+}
+
+//--------------------------------------------------------------
+void ofApp::draw() {
+
+}
+
+//--------------------------------------------------------------
+void ofApp::parseArguments() {
+	for (size_t i = 0; i < arguments.size(); ++i) {
+		const string& argument = arguments[i];
+		bool hasValue = i + 1 < arguments.size();
+
+		if (argument == "--seeds" && hasValue) {
+			nSeeds = max(ofToInt(arguments[++i]), 1);
+		} else if (argument == "--size" && hasValue) {
+			syntheticImageSize = max(ofToInt(arguments[++i]), 0);
+		} else if (argument == "--batch" && hasValue) {
+			batchSize = max(ofToInt(arguments[++i]), 1);
+		} else if (argument == "--threads" && hasValue) {
+			nThreads = max(ofToInt(arguments[++i]), 0);
+		} else if (argument == "--tiles" && hasValue) {
+			tileSize = max(ofToInt(arguments[++i]), 0);
+		} else if (argument == "--storage" && hasValue) {
+			storageDirectory = arguments[++i];
+		} else if (argument == "--prefilter") {
+			seedPrefilter = true;
+		} else if (argument == "--importance") {
+			importanceSampling = true;
+		} else if (argument == "--error-weighted") {
+			errorWeightedSampling = true;
+		} else if (argument == "--traces-per-update" && hasValue) {
+			tracesPerUpdate = max(ofToInt(arguments[++i]), 1);
+		} else if (argument == "--budget" && hasValue) {
+			updateBudget = max(ofToInt(arguments[++i]), 0);
+		} else if (argument == "--no-buffer") {
+			useCanvasBuffer = false;
+		} else if (argument.compare(0, 2, "--") == 0) {
+			ofLogWarning() << "Ignoring unknown benchmark option " << argument;
+		} else {
+			imagePaths.push_back(argument);
+		}
+	}
+}
+
+//--------------------------------------------------------------
+void ofApp::createSyntheticImages() {
+	// A size of zero disables the synthetic images
+	int size = syntheticImageSize;
+
+	if (size == 0) {
+		return;
+	}
+
+	// Smooth color gradient
+	BenchmarkImage gradient = { "gradient", ofPixels() };
+	gradient.pixels.allocate(size, size, OF_PIXELS_RGB);
+
+	for (int y = 0; y < size; ++y) {
+		for (int x = 0; x < size; ++x) {
+			float fx = float(x) / size;
+			float fy = float(y) / size;
+			gradient.pixels.setColor(x, y, ofColor(255 * fx, 255 * fy, 255 * (1 - 0.5 * (fx + fy))));
+		}
+	}
+
+	images.push_back(gradient);
+
+	// Overlapping circles with sharp edges. The random stream key is fixed, so the image never changes.
+	ofxOilRandom random(1);
+	BenchmarkImage circles = { "circles", ofPixels() };
+	circles.pixels.allocate(size, size, OF_PIXELS_RGB);
+	circles.pixels.setColor(ofColor(random.nextFloat(255), random.nextFloat(255), random.nextFloat(255)));
+
+	for (unsigned int i = 0; i < 60; ++i) {
+		glm::vec2 center(random.nextFloat(size), random.nextFloat(size));
+		float radius = random.nextFloat(0.02, 0.15) * size;
+		ofColor color(random.nextFloat(255), random.nextFloat(255), random.nextFloat(255));
+		int xMin = max(int(center.x - radius), 0);
+		int yMin = max(int(center.y - radius), 0);
+		int xMax = min(int(center.x + radius) + 1, size);
+		int yMax = min(int(center.y + radius) + 1, size);
+
+		for (int y = yMin; y < yMax; ++y) {
+			for (int x = xMin; x < xMax; ++x) {
+				if (glm::distance(glm::vec2(x, y), center) < radius) {
+					circles.pixels.setColor(x, y, color);
+				}
+			}
+		}
+	}
+
+	images.push_back(circles);
+
+	// Superposition of color waves with different frequencies and orientations
+	BenchmarkImage waves = { "waves", ofPixels() };
+	waves.pixels.allocate(size, size, OF_PIXELS_RGB);
+	array<glm::vec3, 12> waveParameters;
+
+	for (glm::vec3& parameters : waveParameters) {
+		parameters = glm::vec3(random.nextFloat(-20, 20), random.nextFloat(-20, 20), random.nextFloat(TWO_PI));
+	}
+
+	for (int y = 0; y < size; ++y) {
+		for (int x = 0; x < size; ++x) {
+			float fx = float(x) / size;
+			float fy = float(y) / size;
+			array<float, 3> channels = { 0, 0, 0 };
+
+			for (size_t i = 0; i < waveParameters.size(); ++i) {
+				const glm::vec3& parameters = waveParameters[i];
+				channels[i % 3] += sin(parameters.x * fx + parameters.y * fy + parameters.z);
+			}
+
+			int nWaves = waveParameters.size() / 3;
+			waves.pixels.setColor(x, y,
+					ofColor(127.5 * (1 + channels[0] / nWaves), 127.5 * (1 + channels[1] / nWaves),
+							127.5 * (1 + channels[2] / nWaves)));
+		}
+	}
+
+	images.push_back(waves);
+}
+
+//--------------------------------------------------------------
+void ofApp::loadImages() {
+	for (const string& path : imagePaths) {
+		BenchmarkImage image = { path, ofPixels() };
+
+		if (!ofLoadImage(image.pixels, ofToDataPath(path))) {
+			ofLogError() << "Could not load the benchmark image " << path;
+			continue;
+		}
+
+		image.pixels.setImageType(OF_IMAGE_COLOR);
+		images.push_back(image);
+	}
+}
+
+//--------------------------------------------------------------
+ofApp::BenchmarkRun ofApp::paint(const BenchmarkImage& image, uint64_t seed, bool useSeedPrefilter) const {
+	BenchmarkRun run;
+	run.image = image.name;
+	run.width = image.pixels.getWidth();
+	run.height = image.pixels.getHeight();
+	run.seed = seed;
+
+	// Set the simulation parameters
+	ofxOilConfig config;
+	config.seedPrefilter = useSeedPrefilter;
+	config.importanceSampling = importanceSampling;
+	config.errorWeightedSampling = errorWeightedSampling;
+	config.maxTracesPerUpdate = tracesPerUpdate;
+
+	// Paint on the CPU, so the benchmark doesn't depend on the GPU or the window refresh rate
+	if (tileSize > 0) {
+		ofxOilTiledSimulator simulator(tileSize, nThreads, useCanvasBuffer, config);
+		simulator.setSeed(seed);
+		simulator.setStorageDirectory(storageDirectory);
+		paint(simulator, image, run, [&simulator]() {
+			simulator.update();
+		});
+	} else {
+		ofxOilSimulator simulator(useCanvasBuffer, false, OFX_OIL_CANVAS_PIXELS, config);
+		simulator.setSeed(seed);
+		simulator.setNThreads(nThreads);
+		simulator.setSpeculativeSearch(batchSize, nThreads);
+		paint(simulator, image, run, [this, &simulator]() {
+			if (updateBudget > 0) {
+				simulator.updateWithBudget(updateBudget);
+			} else {
+				simulator.update(false);
+			}
+		});
+	}
+
+	return run;
+}
+
+//--------------------------------------------------------------
+template<class Simulator>
+void ofApp::paint(Simulator& simulator, const BenchmarkImage& image, BenchmarkRun& run,
+		const function<void()>& update) const {
+	auto start = chrono::steady_clock::now();
+	simulator.setImagePixels(image.pixels, true);
+
+	// Paint the image, keeping track of the time spent with each brush size. The brush size can only change at the
+	// start of an update, so the levels are measured with the resolution of one update.
+	BrushLevel level = { simulator.getAverageBrushSize(), 0, 0, 0 };
+	auto levelStart = start;
+	unsigned int levelStartTraces = 0;
+	uint64_t levelStartCandidates = 0;
+	run.maxUpdateSeconds = 0;
+
+	while (!simulator.isFinished()) {
+		auto updateStart = chrono::steady_clock::now();
+		update();
+		run.maxUpdateSeconds = max(run.maxUpdateSeconds,
+				chrono::duration<double>(chrono::steady_clock::now() - updateStart).count());
+
+		if (simulator.getAverageBrushSize() != level.brushSize || simulator.isFinished()) {
+			auto now = chrono::steady_clock::now();
+			level.seconds = chrono::duration<double>(now - levelStart).count();
+			level.traces = simulator.getNTraces() - levelStartTraces;
+			level.candidates = simulator.getStats().getNCandidates() - levelStartCandidates;
+			run.levels.push_back(level);
+
+			level = { simulator.getAverageBrushSize(), 0, 0, 0 };
+			levelStart = now;
+			levelStartTraces = simulator.getNTraces();
+			levelStartCandidates = simulator.getStats().getNCandidates();
+		}
+	}
+
+	run.seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+	run.traces = simulator.getNTraces();
+	run.candidates = simulator.getStats().getNCandidates();
+	run.stats = simulator.getStats();
+
+	// Calculate the average color channel difference between the painting and the image
+	const ofPixels& canvasPixels = simulator.getCanvasPixels();
+	size_t nImageChannels = image.pixels.getNumChannels();
+	size_t nCanvasChannels = canvasPixels.getNumChannels();
+	size_t nPixels = size_t(run.width) * run.height;
+	uint64_t differenceSum = 0;
+
+	for (size_t pixel = 0; pixel < nPixels; ++pixel) {
+		for (size_t c = 0; c < 3; ++c) {
+			differenceSum += abs(image.pixels[pixel * nImageChannels + c] - canvasPixels[pixel * nCanvasChannels + c]);
+		}
+	}
+
+	run.colorError = differenceSum / (3.0 * max(nPixels, size_t(1)));
+}
+
+//--------------------------------------------------------------
+void ofApp::printReport() const {
+	ostringstream report;
+	report << fixed << setprecision(6);
+	report << "{\n";
+	report << "  \"benchmark\": \"ofxOilSimulator\",\n";
+	report << "  \"settings\": {\"seeds\": " << nSeeds << ", \"batchSize\": " << batchSize << ", \"threads\": "
+			<< nThreads << ", \"tileSize\": " << tileSize << ", \"seedPrefilter\": "
+			<< (seedPrefilter ? "true" : "false")
+			<< ", \"importanceSampling\": " << (importanceSampling ? "true" : "false")
+			<< ", \"errorWeightedSampling\": " << (errorWeightedSampling ? "true" : "false")
+			<< ", \"tracesPerUpdate\": " << tracesPerUpdate << ", \"updateBudget\": " << updateBudget
+			<< ", \"canvasBuffer\": "
+			<< (useCanvasBuffer ? "true" : "false") << ", \"instructionSet\": \""
+			<< ofxOilSimilarityKernel::getInstructionSet() << "\"},\n";
+	report << "  \"totalSeconds\": " << totalSeconds << ",\n";
+	report << "  \"peakMemoryKB\": " << getPeakMemory() << ",\n";
+	report << "  \"runs\": [";
+
+	for (size_t i = 0; i < runs.size(); ++i) {
+		const BenchmarkRun& run = runs[i];
+		double seconds = max(run.seconds, 1e-9);
+		uint64_t rejected = run.candidates - run.traces;
+
+		report << (i == 0 ? "\n" : ",\n");
+		report << "    {\"image\": " << toJsonString(run.image) << ", \"width\": " << run.width << ", \"height\": "
+				<< run.height << ", \"seed\": " << run.seed << ",\n";
+		report << "     \"seconds\": " << run.seconds << ", \"maxUpdateSeconds\": " << run.maxUpdateSeconds
+				<< ", \"traces\": " << run.traces << ", \"tracesPerSecond\": " << run.traces / seconds
+				<< ", \"colorError\": " << run.colorError << ",\n";
+
+		if (i < referenceRuns.size()) {
+			report << "     \"reference\": {\"traces\": " << referenceRuns[i].traces << ", \"colorError\": "
+					<< referenceRuns[i].colorError << "},\n";
+		}
+
+		report << "     \"candidates\": " << run.candidates << ", \"candidatesPerSecond\": "
+				<< run.candidates / seconds << ", \"rejectedCandidates\": " << rejected
+				<< ", \"acceptanceRatio\": " << (run.candidates > 0 ? double(run.traces) / run.candidates : 0)
+				<< ",\n";
+		const ofxOilSimulatorStats& stats = run.stats;
+		report << "     \"rejections\": {\"visited\": " << stats.visitedRejections << ", \"outsideCanvas\": "
+				<< stats.outsideCanvasRejections << ", \"wellPainted\": " << stats.wellPaintedRejections
+				<< ", \"highColorStdev\": " << stats.highColorStdevRejections << ", \"batchOverlap\": "
+				<< stats.batchOverlapRejections << ", \"noImprovement\": " << stats.noImprovementRejections
+				<< "}, \"seedPrefilterRedraws\": " << stats.seedPrefilterRedraws << ",\n";
+		report << "     \"phases\": {\"updatePixelArrays\": " << toJson(stats.updatePixelArrays) << ", \"search\": "
+				<< toJson(stats.search) << ",\n";
+		report << "       \"varianceMap\": " << toJson(stats.varianceMap) << ", \"stdevBoundMap\": "
+				<< toJson(stats.stdevBoundMap) << ", \"importanceMap\": " << toJson(stats.importanceMap) << ",\n";
+		report << "       \"trajectoryGeneration\": " << toJson(stats.trajectoryGeneration)
+				<< ", \"visitedTrajectoryCheck\": " << toJson(stats.visitedTrajectoryCheck) << ",\n";
+		report << "       \"validTrajectoryCheck\": " << toJson(stats.validTrajectoryCheck)
+				<< ", \"colorsCalculation\": " << toJson(stats.colorsCalculation) << ",\n";
+		report << "       \"improvementCheck\": " << toJson(stats.improvementCheck) << ", \"painting\": "
+				<< toJson(stats.painting) << "},\n";
+		report << "     \"levels\": [";
+
+		for (size_t j = 0; j < run.levels.size(); ++j) {
+			const BrushLevel& level = run.levels[j];
+			report << (j == 0 ? "" : ", ") << "{\"brushSize\": " << level.brushSize << ", \"seconds\": "
+					<< level.seconds << ", \"traces\": " << level.traces << ", \"candidates\": " << level.candidates
+					<< "}";
+		}
+
+		report << "]}";
+	}
+
+	report << "\n  ]\n";
+	report << "}\n";
+
+	cout << report.str();
+	cout.flush();
+}
+
+//--------------------------------------------------------------
+bool ofApp::checkUpdateBudget() const {
+	// A budgeted update can only exceed its budget by the pixel arrays update before the search and the evaluation of
+	// the last candidates batch, so it should never take more than twice the budget plus a small margin
+	if (updateBudget == 0 || tileSize > 0) {
+		return true;
+	}
+
+	double maxSeconds = 2e-6 * updateBudget + 0.005;
+	bool respected = true;
+
+	for (const BenchmarkRun& run : runs) {
+		if (run.maxUpdateSeconds > maxSeconds) {
+			ofLogError() << "The longest update painting " << run.image << " with seed " << run.seed << " took "
+					<< run.maxUpdateSeconds << " seconds, more than the " << maxSeconds << " seconds allowed";
+			respected = false;
+		}
+	}
+
+	return respected;
+}
+
+//--------------------------------------------------------------
+bool ofApp::checkSeedPrefilter() const {
+	// The seed prefilter only discards starting pixels whose trajectories will be rejected, so the paintings should
+	// keep the same number of traces and color error, apart from the changes caused by the different random draws
+	const double tolerance = 0.05;
+	bool kept = true;
+
+	for (size_t i = 0; i < referenceRuns.size(); ++i) {
+		const BenchmarkRun& run = runs[i];
+		const BenchmarkRun& reference = referenceRuns[i];
+		bool sameTraces = abs(double(run.traces) - reference.traces) <= tolerance * reference.traces;
+		bool sameError = abs(run.colorError - reference.colorError) <= tolerance * reference.colorError + 0.1;
+
+		if (!sameTraces || !sameError) {
+			ofLogError() << "The seed prefilter changed the painting of " << run.image << " with seed " << run.seed
+					<< ": " << run.traces << " traces and " << run.colorError << " color error, instead of "
+					<< reference.traces << " traces and " << reference.colorError << " color error";
+			kept = false;
+		}
+	}
+
+	return kept;
+}
+
+//--------------------------------------------------------------
+long ofApp::getPeakMemory() {
+	// Returns the peak resident memory of the process in kilobytes
+#ifdef TARGET_WIN32
+	PROCESS_MEMORY_COUNTERS counters;
+	GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters));
+	return counters.PeakWorkingSetSize / 1024;
+#else
+	rusage usage;
+	getrusage(RUSAGE_SELF, &usage);
+#ifdef TARGET_OSX
+	return usage.ru_maxrss / 1024;
+#else
+	return usage.ru_maxrss;
+#endif
+#endif
+}
+
+//--------------------------------------------------------------
+string ofApp::toJson(const ofxOilPhaseStats& phase) {
+	ostringstream json;
+	json << fixed << setprecision(6) << "{\"seconds\": " << phase.seconds << ", \"calls\": " << phase.calls << "}";
+	return json.str();
+}
+
+//--------------------------------------------------------------
+string ofApp::toJsonString(const string& str) {
+	string result = "\"";
+
+	for (char c : str) {
+		if (c == '"' || c == '\\') {
+			result += '\\';
+			result += c;
+		} else if (c == '\n') {
+			result += "\\n";
+		} else if (c == '\t') {
+			result += "\\t";
+		} else {
+			result += c;
+		}
+	}
+
+	return result + "\"";
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include "ofMain.h"
+#include "ofxOilPaint.h"
+
+class ofApp: public ofBaseApp {
+public:
+	ofApp(const vector<string>& _arguments);
+
+	void setup();
+	void update();
+	void draw();
+
+	// The benchmark input image
+	struct BenchmarkImage {
+		string name;
+		ofPixels pixels;
+	};
+
+	// The time spent painting with a given average brush size
+	struct BrushLevel {
+		float brushSize;
+		double seconds;
+		unsigned int traces;
+		uint64_t candidates;
+	};
+
+	// The result of painting one image with one seed
+	struct BenchmarkRun {
+		string image;
+		int width;
+		int height;
+		uint64_t seed;
+		double seconds;
+		unsigned int traces;
+		uint64_t candidates;
+		double maxUpdateSeconds;
+		double colorError;
+		vector<BrushLevel> levels;
+		ofxOilSimulatorStats stats;
+	};
+
+	// Benchmark helper methods
+	void parseArguments();
+	void createSyntheticImages();
+	void loadImages();
+	BenchmarkRun paint(const BenchmarkImage& image, uint64_t seed, bool useSeedPrefilter) const;
+	template<class Simulator>
+	void paint(Simulator& simulator, const BenchmarkImage& image, BenchmarkRun& run,
+			const function<void()>& update) const;
+	void printReport() const;
+	bool checkUpdateBudget() const;
+	bool checkSeedPrefilter() const;
+	static long getPeakMemory();
+	static string toJson(const ofxOilPhaseStats& phase);
+	static string toJsonString(const string& str);
+
+	// The command line arguments
+	vector<string> arguments;
+	// The width and height of the synthetic images
+	int syntheticImageSize = 400;
+	// The number of seeds used to paint each image
+	unsigned int nSeeds = 3;
+	// The number of candidate traces evaluated at once by the simulator
+	unsigned int batchSize = 1;
+	// The number of threads used to evaluate the candidate traces (zero uses all the hardware threads)
+	unsigned int nThreads = 0;
+	// The minimum tile size of the tiled simulator (zero uses the simple simulator)
+	unsigned int tileSize = 0;
+	// The directory where the tiled simulator stores the image and the canvas (empty stores them in memory)
+	string storageDirectory;
+	// Draw again the trace starting pixels whose trajectories will have a too high color standard deviation
+	bool seedPrefilter = false;
+	// Draw the trace starting pixels with importance sampling
+	bool importanceSampling = false;
+	// Draw the trace starting pixels in proportion to their color error
+	bool errorWeightedSampling = false;
+	// The maximum number of non-overlapping traces accepted between two pixel arrays updates
+	unsigned int tracesPerUpdate = 1;
+	// Use a canvas buffer for the color mixing calculation
+	bool useCanvasBuffer = true;
+	// The time budget of each simple simulator update in microseconds (zero paints one trace per update)
+	unsigned int updateBudget = 0;
+	// The paths of the images to paint in addition to the synthetic ones
+	vector<string> imagePaths;
+
+	// Application variables
+	vector<BenchmarkImage> images;
+	vector<BenchmarkRun> runs;
+	// The runs painted without the seed prefilter, used to check that it doesn't change the paintings
+	vector<BenchmarkRun> referenceRuns;
+	double totalSeconds = 0;
+};
@@ -7,10 +7,8 @@ void ofApp::setup() {
 	backgroundColor = ofColor(255);
 
 	// Initialize the canvas where we are going to paint
-	canvas.allocate(ofGetWidth(), ofGetHeight(), GL_RGB, 3);
-	canvas.begin();
-	ofClear(backgroundColor);
-	canvas.end();
+	canvas = ofxOilFboCanvas(3);
+	canvas.allocate(ofGetWidth(), ofGetHeight(), backgroundColor);
 
 	// Initialize the application variables
 	alphaValue = 0;
@@ -20,7 +18,8 @@ void ofApp::setup() {
 //--------------------------------------------------------------
 void ofApp::update() {
 	// Get the canvas pixels
-	canvas.readToPixels(canvasPixels);
+	canvas.updatePixels();
+	const ofPixels& canvasPixels = canvas.getPixels();
 	int width = canvasPixels.getWidth();
 	int height = canvasPixels.getHeight();
 
@@ -68,7 +67,7 @@ void ofApp::update() {
 
 		// Paint the brush on the canvas
 		if (alphaValue > 0) {
-			brush.paint(currentBristleColors, alphaValue);
+			brush.paint(canvas, currentBristleColors, alphaValue);
 		}
 
 		// Move to the next path length value
@@ -115,9 +114,9 @@ void ofApp::mouseDragged(int x, int y, int button) {
 
 //--------------------------------------------------------------
 void ofApp::mousePressed(int x, int y, int button) {
-	// Create a new brush
+	// Create a new brush with its own random number stream
 	glm::vec2 mousePos = glm::vec2(x, y);
-	brush = ofxOilBrush(mousePos, ofRandom(50, 70));
+	brush = ofxOilBrush(mousePos, ofRandom(50, 70), ofxOilRandom(ofGetElapsedTimeMicros()));
 
 	// Calculate the brush bristles colors
 	initialBristleColors.clear();
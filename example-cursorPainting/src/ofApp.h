@@ -20,8 +20,7 @@ public:
 	void gotMessage(ofMessage msg);
 
 	ofColor backgroundColor;
-	ofFbo canvas;
-	ofPixels canvasPixels;
+	ofxOilFboCanvas canvas;
 	ofxOilBrush brush;
 	vector<ofColor> initialBristleColors;
 	vector<ofColor> currentBristleColors;
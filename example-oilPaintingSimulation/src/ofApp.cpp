@@ -23,7 +23,9 @@ void ofApp::setup() {
 	}
 
 	// Initialize the oil painting simulator
-	simulator = ofxOilSimulator(useCanvasBuffer, true);
+	ofxOilConfig config;
+	config.pipelinedSearchCandidates = pipelinedSearchCandidates;
+	simulator = ofxOilSimulator(useCanvasBuffer, true, OFX_OIL_CANVAS_FBO, config);
 	simulator.setImage(img, true);
 }
 
@@ -31,7 +33,11 @@ void ofApp::setup() {
 void ofApp::update() {
 	// Update the simulator if the painting is not finished
 	if (!simulator.isFinished()) {
-		simulator.update(paintStepByStep);
+		if (paintingBudget > 0) {
+			simulator.updateWithBudget(paintingBudget);
+		} else {
+			simulator.update(paintStepByStep);
+		}
 	}
 
 	// Update the window title
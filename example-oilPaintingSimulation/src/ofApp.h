@@ -31,6 +31,10 @@ public:
 	bool debugMode = true;
 	// Paint the traces step by step, or in one go
 	bool paintStepByStep = true;
+	// The number of candidates evaluated for the next trace after each painted step (0 searches after each trace)
+	unsigned int pipelinedSearchCandidates = 20;
+	// The time in microseconds spent painting in each frame (0 paints one trace or trace step per frame)
+	unsigned int paintingBudget = 0;
 
 	// Application variables
 	ofImage img;
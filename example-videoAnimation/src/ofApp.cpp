@@ -3,14 +3,17 @@
 
 //--------------------------------------------------------------
 void ofApp::setup() {
-	// Load and start the video
-	video.load(videoFile);
-	video.play();
-	video.setPaused(true);
+	// Change some of the simulator default parameters
+	ofxOilConfig config;
+	config.maxColorDifference = {60, 60, 60};
+
+	// Start painting the video frames in the background
+	painter.reset(new ofxOilVideoPainter(4, useCanvasBuffer, repaintOnlyChanges && !startWithCleanCanvas, config));
+	painter->start(videoFile, sizeReductionFactor);
 
 	// Select the image size
-	imgWidth = video.getWidth() / sizeReductionFactor;
-	imgHeight = video.getHeight() / sizeReductionFactor;
+	imgWidth = painter->getWidth();
+	imgHeight = painter->getHeight();
 
 	// Resize the application window
 	if (comparisonMode) {
@@ -18,39 +21,31 @@ void ofApp::setup() {
 	} else {
 		ofSetWindowShape(imgWidth, imgHeight);
 	}
-
-	// Initialize the oil painting simulator
-	simulator = ofxOilSimulator(false, false);
-
-	// Change some of the simulator default parameters
-	ofxOilSimulator::MAX_COLOR_DIFFERENCE = {60, 60, 60};
 }
 
 //--------------------------------------------------------------
 void ofApp::update() {
-	// Move the video to the next frame
-	video.setFrame(ofGetFrameNum() % video.getTotalNumFrames());
-	video.update();
-
-	// Save an image of the current frame
-	img.setFromPixels(video.getPixels());
-	img.resize(imgWidth, imgHeight);
-
-	// Obtain an oil paint of the current image
-	simulator.setImage(img, startWithCleanCanvas);
-
-	while (!simulator.isFinished()) {
-		simulator.update(false);
+	// Get the next painted frame if it's ready
+	ofxOilVideoPainter::Frame frame;
+
+	if (painter->getPaintedFrame(frame)) {
+		canvasTexture.loadData(frame.canvasPixels);
+		imageTexture.loadData(frame.pixels);
+	} else if (painter->isFinished()) {
+		// Start again from the beginning of the video
+		painter->start(videoFile, sizeReductionFactor);
 	}
 }
 
 //--------------------------------------------------------------
 void ofApp::draw() {
 	// Draw the result on the screen
-	simulator.drawCanvas(0, 0);
+	if (canvasTexture.isAllocated()) {
+		canvasTexture.draw(0, 0);
 
-	if (comparisonMode) {
-		simulator.drawImage(imgWidth, 0);
+		if (comparisonMode) {
+			imageTexture.draw(imgWidth, 0);
+		}
 	}
 }
 
@@ -28,13 +28,15 @@ public:
 	bool useCanvasBuffer = false;
 	// Paint each picture with a clean canvas
 	bool startWithCleanCanvas = false;
+	// Repaint only the regions that changed since the previous picture (ignored if the canvas is cleaned)
+	bool repaintOnlyChanges = true;
 	// Compare the oil paint simulation with the video picture
 	bool comparisonMode = true;
 
 	// Application variables
-	ofVideoPlayer video;
-	ofImage img;
+	unique_ptr<ofxOilVideoPainter> painter;
+	ofTexture canvasTexture;
+	ofTexture imageTexture;
 	int imgWidth;
 	int imgHeight;
-	ofxOilSimulator simulator;
 };
@@ -24,11 +24,22 @@ void ofApp::update() {
 	// Update the webcam
 	webcam.update();
 
-	// Obtain an oil paint of the current webcam image
-	simulator.setImagePixels(webcam.getPixels(), startWithCleanCanvas);
+	// Start painting the current webcam image
+	if (webcam.isFrameNew()) {
+		if (repaintOnlyChanges && !startWithCleanCanvas) {
+			simulator.setVideoFramePixels(webcam.getPixels());
+		} else {
+			simulator.setImagePixels(webcam.getPixels(), startWithCleanCanvas);
+		}
+	}
 
-	while (!simulator.isFinished()) {
-		simulator.update(false);
+	// Paint during the frame time budget, or until the painting is finished
+	if (paintingBudget > 0) {
+		simulator.updateWithBudget(paintingBudget);
+	} else {
+		while (!simulator.isFinished()) {
+			simulator.update(false);
+		}
 	}
 }
 
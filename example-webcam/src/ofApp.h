@@ -27,6 +27,10 @@ public:
 	int webcamFrameRate = 30;
 	// Paint each picture with a clean canvas
 	bool startWithCleanCanvas = false;
+	// Repaint only the regions that changed since the previous picture (ignored if the canvas is cleaned)
+	bool repaintOnlyChanges = true;
+	// The time in microseconds spent painting in each frame (0 finishes each painting before the next frame)
+	unsigned int paintingBudget = 25000;
 	// Compare the oil paint simulation with the webcam picture
 	bool comparisonMode = true;
 
@@ -0,0 +1,146 @@
+#include "ofxOilBatchRenderer.h"
+#include "ofxOilSimulator.h"
+#include "ofxOilThreadPool.h"
+#include "ofxOilRandom.h"
+#include "ofxOilConfig.h"
+#include "ofMain.h"
+
+ofxOilBatchRenderer::ofxOilBatchRenderer(unsigned int nThreads, bool _useCanvasBuffer, const ofxOilConfig& _config) :
+		config(_config), useCanvasBuffer(_useCanvasBuffer), threadPool(nThreads) {
+	setSeed(0);
+}
+
+void ofxOilBatchRenderer::setSeed(uint64_t seed) {
+	random = ofxOilRandom(seed);
+}
+
+uint64_t ofxOilBatchRenderer::getSeed() const {
+	return random.getKey();
+}
+
+unsigned int ofxOilBatchRenderer::render(const function<bool(ofPixels&)>& frameSource,
+		const function<void(unsigned int, const ofPixels&)>& frameSink, int width, int height) {
+	// The frames that were obtained from the source but not written yet are limited to avoid using too much memory
+	unsigned int nThreads = threadPool.getNThreads();
+	unsigned int maxPendingFrames = 2 * nThreads;
+
+	// Variables shared by all the threads, protected by the mutex
+	mutex renderMutex;
+	condition_variable frameWritten;
+	unsigned int nextFrame = 0;
+	unsigned int nextFrameToWrite = 0;
+	bool sourceIsFinished = false;
+	bool isWriting = false;
+	map<unsigned int, ofPixels> paintedFrames;
+	stats = ofxOilSimulatorStats();
+
+	// Each thread paints frames until the source is finished
+	threadPool.parallelFor(nThreads, [&](unsigned int) {
+		while (true) {
+			// Get the next frame from the source
+			unsigned int index;
+			ofPixels pixels;
+
+			{
+				unique_lock<mutex> lock(renderMutex);
+				frameWritten.wait(lock, [&] {
+					return sourceIsFinished || nextFrame < nextFrameToWrite + maxPendingFrames;
+				});
+
+				if (sourceIsFinished || !frameSource(pixels)) {
+					sourceIsFinished = true;
+					frameWritten.notify_all();
+					break;
+				}
+
+				index = nextFrame++;
+			}
+
+			// Paint the frame on a clean canvas with its own random number stream
+			if (width > 0 && height > 0 && ((int) pixels.getWidth() != width || (int) pixels.getHeight() != height)) {
+				pixels.resize(width, height);
+			}
+
+			ofxOilSimulator simulator(useCanvasBuffer, false, OFX_OIL_CANVAS_PIXELS, config);
+			simulator.setSeed(random.derive(index).getKey());
+			simulator.setImagePixels(pixels, true);
+
+			while (!simulator.isFinished()) {
+				simulator.update(false);
+			}
+
+			// Add the painted frame to the frames waiting to be written
+			unique_lock<mutex> lock(renderMutex);
+			paintedFrames[index] = simulator.getCanvasPixels();
+			stats += simulator.getStats();
+
+			// Write all the consecutive frames that are ready, unless another thread is already doing it
+			if (isWriting) {
+				continue;
+			}
+
+			isWriting = true;
+
+			while (!paintedFrames.empty() && paintedFrames.begin()->first == nextFrameToWrite) {
+				ofPixels canvasPixels = move(paintedFrames.begin()->second);
+				paintedFrames.erase(paintedFrames.begin());
+				lock.unlock();
+				frameSink(nextFrameToWrite, canvasPixels);
+				lock.lock();
+				++nextFrameToWrite;
+				frameWritten.notify_all();
+			}
+
+			isWriting = false;
+		}
+	});
+
+	return nextFrame;
+}
+
+unsigned int ofxOilBatchRenderer::renderVideo(const string& videoPath, const string& outputPathPrefix,
+		float sizeReductionFactor, const string& extension) {
+	// Load the video. The frames pixels are only needed on the CPU.
+	ofVideoPlayer video;
+	video.setUseTexture(false);
+
+	if (!video.load(videoPath)) {
+		throw runtime_error("The video file " + videoPath + " could not be loaded.");
+	}
+
+	video.setLoopState(OF_LOOP_NONE);
+	video.play();
+	video.setPaused(true);
+	video.setFrame(0);
+
+	// Decode the frames sequentially, without seeking
+	unsigned int nVideoFrames = video.getTotalNumFrames();
+	unsigned int nDecodedFrames = 0;
+	auto frameSource = [&video, &nDecodedFrames, nVideoFrames](ofPixels& pixels) {
+		if (nDecodedFrames >= nVideoFrames) {
+			return false;
+		}
+
+		if (nDecodedFrames > 0) {
+			video.nextFrame();
+		}
+
+		video.update();
+		pixels = video.getPixels();
+		pixels.setImageType(OF_IMAGE_COLOR);
+		++nDecodedFrames;
+		return true;
+	};
+
+	// Save the painted frames as an image sequence
+	auto frameSink = [&outputPathPrefix, &extension](unsigned int index, const ofPixels& canvasPixels) {
+		ofSaveImage(canvasPixels, outputPathPrefix + ofToString(index, 6, '0') + "." + extension);
+	};
+
+	return render(frameSource, frameSink, video.getWidth() / sizeReductionFactor,
+			video.getHeight() / sizeReductionFactor);
+}
+
+const ofxOilSimulatorStats& ofxOilBatchRenderer::getStats() const {
+	return stats;
+}
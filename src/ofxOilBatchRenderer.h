@@ -0,0 +1,108 @@
+#pragma once
+
+#include "ofMain.h"
+#include "ofxOilThreadPool.h"
+#include "ofxOilRandom.h"
+#include "ofxOilConfig.h"
+#include "ofxOilSimulatorStats.h"
+
+/**
+ * @brief Class used to paint offline a sequence of independent frames using several threads
+ *
+ * Each frame is painted on a clean canvas by its own CPU simulator, so several frames can be painted at the same time.
+ * The simulator random number stream is derived from the renderer seed and the frame index, so the painted frames
+ * don't depend on the number of threads. The painted frames are written in order.
+ *
+ * @author Javier Graciá Carpio
+ */
+class ofxOilBatchRenderer {
+public:
+
+	/**
+	 * @brief Constructor
+	 *
+	 * @param nThreads the number of frames painted at the same time. If zero, the number of hardware threads will be
+	 * used.
+	 * @param _useCanvasBuffer sets if the simulators should use a canvas buffer for the color mixing calculation
+	 * @param _config the simulation parameters
+	 */
+	ofxOilBatchRenderer(unsigned int nThreads = 0, bool _useCanvasBuffer = false,
+			const ofxOilConfig& _config = ofxOilConfig());
+
+	/**
+	 * @brief Sets the seed of the renderer random number stream
+	 *
+	 * @param seed the random number stream seed
+	 */
+	void setSeed(uint64_t seed);
+
+	/**
+	 * @brief Returns the seed of the renderer random number stream
+	 *
+	 * @return the random number stream seed
+	 */
+	uint64_t getSeed() const;
+
+	/**
+	 * @brief Paints all the frames obtained from a frame source
+	 *
+	 * The frame source is called from one thread at a time. The frame sink is called from one thread at a time and
+	 * in the frame order.
+	 *
+	 * @param frameSource the function used to obtain the next frame pixels. It should return false when there are no
+	 * more frames.
+	 * @param frameSink the function called with the frame index and the canvas pixels after painting each frame
+	 * @param width the painted frames width. If zero, the frames are not resized.
+	 * @param height the painted frames height. If zero, the frames are not resized.
+	 * @return the number of painted frames
+	 */
+	unsigned int render(const function<bool(ofPixels&)>& frameSource,
+			const function<void(unsigned int, const ofPixels&)>& frameSink, int width = 0, int height = 0);
+
+	/**
+	 * @brief Paints all the frames of a video file and saves them as an image sequence
+	 *
+	 * @param videoPath the video file path
+	 * @param outputPathPrefix the prefix of the output image paths. The frame index and the extension are appended to
+	 * it.
+	 * @param sizeReductionFactor the size reduction factor between the video frames and the painted frames
+	 * @param extension the output images extension
+	 * @return the number of painted frames
+	 */
+	unsigned int renderVideo(const string& videoPath, const string& outputPathPrefix, float sizeReductionFactor = 1.0,
+			const string& extension = "png");
+
+	/**
+	 * @brief Returns the timing and candidate rejection statistics of all the frame simulators
+	 *
+	 * @return the statistics accumulated in the last render
+	 */
+	const ofxOilSimulatorStats& getStats() const;
+
+protected:
+
+	/**
+	 * @brief The simulation parameters
+	 */
+	ofxOilConfig config;
+
+	/**
+	 * @brief Sets if the simulators should use a canvas buffer for the color mixing calculation
+	 */
+	bool useCanvasBuffer;
+
+	/**
+	 * @brief The renderer random number stream
+	 */
+	ofxOilRandom random;
+
+	/**
+	 * @brief The thread pool used to paint the frames in parallel
+	 */
+	ofxOilThreadPool threadPool;
+
+	/**
+	 * @brief The timing and candidate rejection statistics of all the frame simulators
+	 */
+	ofxOilSimulatorStats stats;
+};
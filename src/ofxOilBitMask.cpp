@@ -0,0 +1,156 @@
+#include "ofxOilBitMask.h"
+#include "ofMain.h"
+
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#endif
+
+ofxOilBitMask::ofxOilBitMask() :
+		width(0), height(0), wordsPerRow(0) {
+}
+
+void ofxOilBitMask::allocate(int _width, int _height, bool value) {
+	// Check that the input makes sense
+	if (_width < 0 || _height < 0) {
+		throw invalid_argument("The mask dimensions cannot be negative.");
+	}
+
+	width = _width;
+	height = _height;
+	wordsPerRow = (size_t(width) + 63) / 64;
+	words.resize(wordsPerRow * height);
+	setAll(value);
+}
+
+void ofxOilBitMask::setAll(bool value) {
+	if (!value) {
+		fill(words.begin(), words.end(), 0);
+		return;
+	}
+
+	// Keep the bits after the last pixel of each row unset
+	for (int y = 0; y < height; ++y) {
+		uint64_t* row = words.data() + y * wordsPerRow;
+
+		for (size_t word = 0; word < wordsPerRow; ++word) {
+			row[word] = getColumnsMask(word, 0, width);
+		}
+	}
+}
+
+bool ofxOilBitMask::isAllocated() const {
+	return width > 0 && height > 0;
+}
+
+int ofxOilBitMask::getWidth() const {
+	return width;
+}
+
+int ofxOilBitMask::getHeight() const {
+	return height;
+}
+
+bool ofxOilBitMask::get(int x, int y) const {
+	return (words[y * wordsPerRow + x / 64] >> (x % 64)) & 1;
+}
+
+void ofxOilBitMask::set(int x, int y, bool value) {
+	uint64_t& word = words[y * wordsPerRow + x / 64];
+	uint64_t bit = uint64_t(1) << (x % 64);
+	word = value ? word | bit : word & ~bit;
+}
+
+void ofxOilBitMask::setRow(int x, int y, unsigned int nPixels, const unsigned char* values) {
+	uint64_t* row = words.data() + y * wordsPerRow;
+
+	for (unsigned int i = 0; i < nPixels; ++i) {
+		int column = x + i;
+		uint64_t bit = uint64_t(1) << (column % 64);
+		uint64_t& word = row[column / 64];
+		word = values[i] != 0 ? word | bit : word & ~bit;
+	}
+}
+
+void ofxOilBitMask::getRow(int x, int y, unsigned int nPixels, unsigned char* values, unsigned char setValue,
+		unsigned char unsetValue) const {
+	const uint64_t* row = words.data() + y * wordsPerRow;
+
+	for (unsigned int i = 0; i < nPixels; ++i) {
+		int column = x + i;
+		values[i] = (row[column / 64] >> (column % 64)) & 1 ? setValue : unsetValue;
+	}
+}
+
+uint64_t ofxOilBitMask::count(int xMin, int yMin, int xMax, int yMax) const {
+	uint64_t counter = 0;
+
+	for (int y = yMin; y < yMax; ++y) {
+		const uint64_t* row = words.data() + y * wordsPerRow;
+
+		for (int word = xMin / 64, end = (xMax + 63) / 64; word < end; ++word) {
+			counter += countBits(row[word] & getColumnsMask(word, xMin, xMax));
+		}
+	}
+
+	return counter;
+}
+
+bool ofxOilBitMask::findSetBit(int xMin, int yMin, int xMax, int yMax, uint64_t n, int& x, int& y) const {
+	// Skip the complete words until we reach the word that contains the set bit
+	for (int row = yMin; row < yMax; ++row) {
+		const uint64_t* rowWords = words.data() + row * wordsPerRow;
+
+		for (int word = xMin / 64, end = (xMax + 63) / 64; word < end; ++word) {
+			uint64_t bits = rowWords[word] & getColumnsMask(word, xMin, xMax);
+			unsigned int nBits = countBits(bits);
+
+			if (n >= nBits) {
+				n -= nBits;
+				continue;
+			}
+
+			// Remove the lower set bits and count the zeros below the lowest remaining set bit
+			for (; n > 0; --n) {
+				bits &= bits - 1;
+			}
+
+			x = 64 * word + countBits((bits & (~bits + 1)) - 1);
+			y = row;
+			return true;
+		}
+	}
+
+	return false;
+}
+
+ofPixels ofxOilBitMask::getPixels(unsigned char setValue, unsigned char unsetValue) const {
+	ofPixels pixels;
+	pixels.allocate(width, height, OF_PIXELS_GRAY);
+
+	for (int y = 0; y < height; ++y) {
+		getRow(0, y, width, pixels.getData() + size_t(y) * width, setValue, unsetValue);
+	}
+
+	return pixels;
+}
+
+unsigned int ofxOilBitMask::countBits(uint64_t word) {
+#if defined(_MSC_VER) && defined(_M_X64)
+	return __popcnt64(word);
+#elif defined(__GNUC__) || defined(__clang__)
+	return __builtin_popcountll(word);
+#else
+	// Add the bits in pairs, nibbles and bytes, and then add the bytes with one multiplication
+	word = word - ((word >> 1) & 0x5555555555555555ULL);
+	word = (word & 0x3333333333333333ULL) + ((word >> 2) & 0x3333333333333333ULL);
+	word = (word + (word >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+	return (word * 0x0101010101010101ULL) >> 56;
+#endif
+}
+
+uint64_t ofxOilBitMask::getColumnsMask(int word, int xMin, int xMax) {
+	int first = max(xMin - 64 * word, 0);
+	int last = min(xMax - 64 * word, 64);
+	uint64_t lastMask = last >= 64 ? ~uint64_t(0) : (uint64_t(1) << max(last, 0)) - 1;
+	return first >= 64 ? 0 : lastMask & (~uint64_t(0) << first);
+}
@@ -1,4 +1,5 @@
 #include "ofxOilBristle.h"
+#include "ofxOilCanvas.h"
 #include "ofMain.h"
 
 ofxOilBristle::ofxOilBristle(const glm::vec2& position, float length) {
@@ -46,20 +47,26 @@ void ofxOilBristle::setElementsLengths(const vector<float>& newLengths) {
 	lengths = newLengths;
 }
 
-void ofxOilBristle::paint(const ofColor& color, float thickness) const {
-	// Set the stroke color
-	ofSetColor(color);
-
+void ofxOilBristle::paint(ofxOilCanvas& canvas, const ofColor& color, float thickness) const {
 	// Paint the bristle elements
 	unsigned int nElements = getNElements();
 	float deltaThickness = thickness / nElements;
 
 	for (unsigned int i = 0; i < nElements; ++i) {
-		ofSetLineWidth(thickness - i * deltaThickness);
-		ofDrawLine(positions[i].x, positions[i].y, 0, positions[i + 1].x, positions[i + 1].y, 0);
+		canvas.drawLine(positions[i], positions[i + 1], thickness - i * deltaThickness, color);
 	}
 }
 
 unsigned int ofxOilBristle::getNElements() const {
 	return lengths.size();
 }
+
+float ofxOilBristle::getLength() const {
+	float length = 0;
+
+	for (float elementLength : lengths) {
+		length += elementLength;
+	}
+
+	return length;
+}
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "ofMain.h"
+#include "ofxOilCanvas.h"
 
 /**
  * @brief Class that simulates the movement of a bristle
@@ -42,10 +43,11 @@ public:
 	/**
 	 * @brief Paints the bristle
 	 *
+	 * @param canvas the canvas where the bristle should be painted
 	 * @param color the color to use
 	 * @param thickness the thickness of the first bristle element
 	 */
-	void paint(const ofColor& color, float thickness) const;
+	void paint(ofxOilCanvas& canvas, const ofColor& color, float thickness) const;
 
 	/**
 	 * @brief Returns the number of bristle elements
@@ -54,6 +56,13 @@ public:
 	 */
 	unsigned int getNElements() const;
 
+	/**
+	 * @brief Returns the bristle total length
+	 *
+	 * @return the sum of the bristle elements lengths
+	 */
+	float getLength() const;
+
 protected:
 
 	/**
@@ -1,36 +1,28 @@
 #include "ofxOilBrush.h"
 #include "ofxOilBristle.h"
+#include "ofxOilCanvas.h"
+#include "ofxOilRandom.h"
+#include "ofxOilConfig.h"
 #include "ofMain.h"
 
-float ofxOilBrush::MAX_BRISTLE_LENGTH = 15;
-
-float ofxOilBrush::MAX_BRISTLE_THICKNESS = 5;
-
-float ofxOilBrush::MAX_BRISTLE_HORIZONTAL_NOISE = 4;
-
-float ofxOilBrush::BRISTLE_VERTICAL_NOISE = 8;
-
-float ofxOilBrush::NOISE_SPEED_FACTOR = 0.04;
-
-unsigned int ofxOilBrush::POSITIONS_FOR_AVERAGE = 4;
-
-ofxOilBrush::ofxOilBrush(const glm::vec2& _position, float _size) :
-		position(_position), size(_size) {
+ofxOilBrush::ofxOilBrush(const glm::vec2& _position, float _size, ofxOilRandom random,
+		shared_ptr<const ofxOilConfig> _config) :
+		config(_config), position(_position), size(_size) {
 	// Calculate some of the bristles properties
-	bristlesLength = min(size, MAX_BRISTLE_LENGTH);
-	bristlesThickness = min(0.8f * bristlesLength, MAX_BRISTLE_THICKNESS);
-	bristlesHorizontalNoise = min(0.3f * size, MAX_BRISTLE_HORIZONTAL_NOISE);
-	bristlesHorizontalNoiseSeed = ofRandom(1000);
+	bristlesLength = min(size, config->maxBristleLength);
+	bristlesThickness = min(0.8f * bristlesLength, config->maxBristleThickness);
+	bristlesHorizontalNoise = min(0.3f * size, config->maxBristleHorizontalNoise);
+	bristlesHorizontalNoiseSeed = random.nextFloat(1000);
 
 	// Initialize the bristles offsets and positions containers with default values
-	unsigned int nBristles = floor(size * ofRandom(1.6, 1.9));
+	unsigned int nBristles = floor(size * random.nextFloat(1.6, 1.9));
 	bOffsets = vector<glm::vec2>(nBristles);
 	bPositions = vector<glm::vec2>(nBristles);
 
 	// Randomize the bristle offset positions
 	for (glm::vec2& offset : bOffsets) {
-		offset.x = size * ofRandom(-0.5, 0.5);
-		offset.y = BRISTLE_VERTICAL_NOISE * ofRandom(-0.5, 0.5);
+		offset.x = size * random.nextFloat(-0.5, 0.5);
+		offset.y = config->bristleVerticalNoise * random.nextFloat(-0.5, 0.5);
 	}
 
 	// Initialize the variables used to calculate the brush average position
@@ -58,10 +50,10 @@ void ofxOilBrush::updatePosition(const glm::vec2& newPosition, bool updateBristl
 	updatesCounter++;
 
 	// Add the new position to the positions history
-	if (positionsHistory.size() < POSITIONS_FOR_AVERAGE) {
+	if (positionsHistory.size() < config->positionsForAverage) {
 		positionsHistory.push_back(position);
 	} else {
-		positionsHistory[updatesCounter % POSITIONS_FOR_AVERAGE] = position;
+		positionsHistory[updatesCounter % config->positionsForAverage] = position;
 	}
 
 	// Update the average position
@@ -78,7 +70,7 @@ void ofxOilBrush::updatePosition(const glm::vec2& newPosition, bool updateBristl
 	averagePosition /= counter;
 
 	// Update the bristles containers only if the average position is stable or is close to be stable
-	if (positionsHistory.size() >= POSITIONS_FOR_AVERAGE - 1) {
+	if (positionsHistory.size() >= config->positionsForAverage - 1) {
 		// Calculate the direction angle
 		float directionAngle = HALF_PI
 				+ atan2(averagePosition.y - prevAveragePosition.y, averagePosition.x - prevAveragePosition.x);
@@ -87,7 +79,7 @@ void ofxOilBrush::updatePosition(const glm::vec2& newPosition, bool updateBristl
 		unsigned int nBristles = getNBristles();
 		float cosAng = cos(directionAngle);
 		float sinAng = sin(directionAngle);
-		float noisePos = bristlesHorizontalNoiseSeed + NOISE_SPEED_FACTOR * updatesCounter;
+		float noisePos = bristlesHorizontalNoiseSeed + config->noiseSpeedFactor * updatesCounter;
 
 		for (unsigned int i = 0; i < nBristles; ++i) {
 			// Add some horizontal noise to the offset to make it look more realistic
@@ -107,7 +99,7 @@ void ofxOilBrush::updatePosition(const glm::vec2& newPosition, bool updateBristl
 				bristles = vector<ofxOilBristle>(nBristles, ofxOilBristle(glm::vec2(), bristlesLength));
 			}
 
-			if (positionsHistory.size() == POSITIONS_FOR_AVERAGE - 1) {
+			if (positionsHistory.size() == config->positionsForAverage - 1) {
 				for (unsigned int i = 0; i < nBristles; ++i) {
 					bristles[i].setElementsPositions(bPositions[i]);
 				}
@@ -120,32 +112,24 @@ void ofxOilBrush::updatePosition(const glm::vec2& newPosition, bool updateBristl
 	}
 }
 
-void ofxOilBrush::paint(const ofColor& color) const {
-	if (positionsHistory.size() == POSITIONS_FOR_AVERAGE) {
-		ofPushStyle();
-
+void ofxOilBrush::paint(ofxOilCanvas& canvas, const ofColor& color) const {
+	if (positionsHistory.size() == config->positionsForAverage) {
 		for (const ofxOilBristle& bristle : bristles) {
-			bristle.paint(color, bristlesThickness);
+			bristle.paint(canvas, color, bristlesThickness);
 		}
-
-		ofPopStyle();
 	}
 }
 
-void ofxOilBrush::paint(const vector<ofColor>& colors, unsigned char alpha) const {
+void ofxOilBrush::paint(ofxOilCanvas& canvas, const vector<ofColor>& colors, unsigned char alpha) const {
 	// Check that the input makes sense
 	if (colors.size() != getNBristles()) {
 		throw invalid_argument("There should be one color for each bristle in the brush.");
 	}
 
-	if (positionsHistory.size() == POSITIONS_FOR_AVERAGE) {
-		ofPushStyle();
-
+	if (positionsHistory.size() == config->positionsForAverage) {
 		for (unsigned int i = 0, nBristles = getNBristles(); i < nBristles; ++i) {
-			bristles[i].paint(ofColor(colors[i], alpha), bristlesThickness);
+			bristles[i].paint(canvas, ofColor(colors[i], alpha), bristlesThickness);
 		}
-
-		ofPopStyle();
 	}
 }
 
@@ -153,6 +137,15 @@ unsigned int ofxOilBrush::getNBristles() const {
 	return bOffsets.size();
 }
 
-const vector<glm::vec2> ofxOilBrush::getBristlesPositions() const {
-	return positionsHistory.size() == POSITIONS_FOR_AVERAGE ? bPositions : vector<glm::vec2>();
+float ofxOilBrush::getSize() const {
+	return size;
+}
+
+const vector<glm::vec2>& ofxOilBrush::getBristlesPositions() const {
+	static const vector<glm::vec2> noPositions;
+	return positionsHistory.size() == config->positionsForAverage ? bPositions : noPositions;
+}
+
+float ofxOilBrush::getPaintingMargin() const {
+	return ofxOilBristle(glm::vec2(), bristlesLength).getLength() + 0.5 * bristlesThickness + 1;
 }
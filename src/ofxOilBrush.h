@@ -2,6 +2,9 @@
 
 #include "ofMain.h"
 #include "ofxOilBristle.h"
+#include "ofxOilCanvas.h"
+#include "ofxOilRandom.h"
+#include "ofxOilConfig.h"
 
 /**
  * @brief Class that simulates a brush composed of several bristles
@@ -11,43 +14,16 @@
 class ofxOilBrush {
 public:
 
-	/**
-	 * @brief The maximum bristle length
-	 */
-	static float MAX_BRISTLE_LENGTH;
-
-	/**
-	 * @brief The maximum bristle thickness
-	 */
-	static float MAX_BRISTLE_THICKNESS;
-
-	/**
-	 * @brief The maximum noise range to add in each update to the bristles horizontal position on the brush
-	 */
-	static float MAX_BRISTLE_HORIZONTAL_NOISE;
-
-	/**
-	 * @brief The noise range to add to the bristles vertical position on the brush
-	 */
-	static float BRISTLE_VERTICAL_NOISE;
-
-	/**
-	 * @brief Controls the bristles horizontal noise speed
-	 */
-	static float NOISE_SPEED_FACTOR;
-
-	/**
-	 * @brief The number of positions to use to calculate the brush average position
-	 */
-	static unsigned int POSITIONS_FOR_AVERAGE;
-
 	/**
 	 * @brief Constructor
 	 *
 	 * @param _position the brush central position
 	 * @param _size the brush size
+	 * @param random the random number stream used to initialize the brush bristles
+	 * @param _config the simulation parameters
 	 */
-	ofxOilBrush(const glm::vec2& _position = glm::vec2(), float _size = 5);
+	ofxOilBrush(const glm::vec2& _position = glm::vec2(), float _size = 5, ofxOilRandom random = ofxOilRandom(),
+			shared_ptr<const ofxOilConfig> _config = ofxOilConfig::getDefault());
 
 	/**
 	 * @brief Moves the brush to a new position and resets some internal variables
@@ -67,17 +43,19 @@ public:
 	/**
 	 * @brief Paints the brush using the provided color
 	 *
+	 * @param canvas the canvas where the brush should be painted
 	 * @param color the brush color
 	 */
-	void paint(const ofColor& color) const;
+	void paint(ofxOilCanvas& canvas, const ofColor& color) const;
 
 	/**
 	 * @brief Paints the brush using the provided bristles colors
 	 *
+	 * @param canvas the canvas where the brush should be painted
 	 * @param colors the bristles colors
 	 * @param alpha the colors alpha value
 	 */
-	void paint(const vector<ofColor>& colors, unsigned char alpha) const;
+	void paint(ofxOilCanvas& canvas, const vector<ofColor>& colors, unsigned char alpha) const;
 
 	/**
 	 * @brief Returns the total number of bristles in the brush
@@ -86,15 +64,35 @@ public:
 	 */
 	unsigned int getNBristles() const;
 
+	/**
+	 * @brief Returns the brush size
+	 *
+	 * @return the brush size
+	 */
+	float getSize() const;
+
 	/**
 	 * @brief Returns the current bristles positions
 	 *
-	 * @return a vector with the current bristles positions
+	 * @return a vector with the current bristles positions. It will be empty until the brush has moved enough times
+	 * to know its direction.
 	 */
-	const vector<glm::vec2> getBristlesPositions() const;
+	const vector<glm::vec2>& getBristlesPositions() const;
+
+	/**
+	 * @brief Returns the maximum distance from the bristles positions that can be covered when the brush is painted
+	 *
+	 * @return the maximum distance covered by the painted bristles, considering their length and thickness
+	 */
+	float getPaintingMargin() const;
 
 protected:
 
+	/**
+	 * @brief The simulation parameters
+	 */
+	shared_ptr<const ofxOilConfig> config;
+
 	/**
 	 * @brief The brush central position
 	 */
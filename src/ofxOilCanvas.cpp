@@ -0,0 +1,12 @@
+#include "ofxOilCanvas.h"
+#include "ofxOilFboCanvas.h"
+#include "ofxOilPixelsCanvas.h"
+#include "ofMain.h"
+
+unique_ptr<ofxOilCanvas> ofxOilCanvas::create(ofxOilCanvasType type, int numSamples) {
+	if (type == OFX_OIL_CANVAS_PIXELS) {
+		return unique_ptr<ofxOilCanvas>(new ofxOilPixelsCanvas());
+	} else {
+		return unique_ptr<ofxOilCanvas>(new ofxOilFboCanvas(numSamples));
+	}
+}
@@ -0,0 +1,116 @@
+#pragma once
+
+#include "ofMain.h"
+
+/**
+ * @brief The available canvas types
+ */
+enum ofxOilCanvasType {
+	/**
+	 * @brief Canvas painted on the GPU using an ofFbo. It requires an OpenGL context.
+	 */
+	OFX_OIL_CANVAS_FBO,
+
+	/**
+	 * @brief Canvas painted on the CPU using an ofPixels container. It can be used in headless applications.
+	 */
+	OFX_OIL_CANVAS_PIXELS
+};
+
+/**
+ * @brief Abstract class representing a surface where the brush bristles can be painted
+ *
+ * @author Javier Graciá Carpio
+ */
+class ofxOilCanvas {
+public:
+
+	/**
+	 * @brief Creates a new canvas of the given type
+	 *
+	 * @param type the canvas type
+	 * @param numSamples the number of samples used for antialiasing (only used by the fbo canvas)
+	 * @return a pointer to the new canvas
+	 */
+	static unique_ptr<ofxOilCanvas> create(ofxOilCanvasType type, int numSamples = 0);
+
+	/**
+	 * @brief Destructor
+	 */
+	virtual ~ofxOilCanvas() {
+	}
+
+	/**
+	 * @brief Allocates the canvas and fills it with the background color
+	 *
+	 * @param width the canvas width
+	 * @param height the canvas height
+	 * @param backgroundColor the canvas background color
+	 */
+	virtual void allocate(int width, int height, const ofColor& backgroundColor) = 0;
+
+	/**
+	 * @brief Allocates the canvas and fills it with the given pixels
+	 *
+	 * @param newPixels the new canvas pixels
+	 */
+	virtual void setPixels(const ofPixels& newPixels) = 0;
+
+	/**
+	 * @brief Starts painting on the canvas
+	 *
+	 * All the drawLine calls should be done between the begin and the end calls.
+	 */
+	virtual void begin() = 0;
+
+	/**
+	 * @brief Stops painting on the canvas
+	 */
+	virtual void end() = 0;
+
+	/**
+	 * @brief Draws a line segment on the canvas
+	 *
+	 * @param startPos the line start position
+	 * @param endPos the line end position
+	 * @param width the line width
+	 * @param color the line color
+	 */
+	virtual void drawLine(const glm::vec2& startPos, const glm::vec2& endPos, float width, const ofColor& color) = 0;
+
+	/**
+	 * @brief Makes sure that the pixels returned by getPixels reflect the latest canvas state
+	 */
+	virtual void updatePixels() = 0;
+
+	/**
+	 * @brief Returns the canvas pixels
+	 *
+	 * Note that the updatePixels method should have been run before.
+	 *
+	 * @return the canvas pixels
+	 */
+	virtual const ofPixels& getPixels() const = 0;
+
+	/**
+	 * @brief Draws the canvas on the screen
+	 *
+	 * @param x the screen x position
+	 * @param y the screen y position
+	 */
+	virtual void draw(float x, float y) const = 0;
+
+	/**
+	 * @brief Returns the canvas width
+	 *
+	 * @return the canvas width
+	 */
+	virtual int getWidth() const = 0;
+
+	/**
+	 * @brief Returns the canvas height
+	 *
+	 * @return the canvas height
+	 */
+	virtual int getHeight() const = 0;
+};
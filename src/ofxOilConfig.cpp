@@ -0,0 +1,7 @@
+#include "ofxOilConfig.h"
+#include "ofMain.h"
+
+shared_ptr<const ofxOilConfig> ofxOilConfig::getDefault() {
+	static shared_ptr<const ofxOilConfig> defaultConfig = make_shared<const ofxOilConfig>();
+	return defaultConfig;
+}
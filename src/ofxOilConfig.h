@@ -0,0 +1,266 @@
+#pragma once
+
+#include "ofMain.h"
+
+/**
+ * @brief Struct containing all the oil painting simulation parameters
+ *
+ * A simulator keeps its own immutable copy of the parameters and shares it with its traces and brushes, so several
+ * simulators with different parameters can run at the same time in different threads.
+ *
+ * @author Javier Graciá Carpio
+ */
+struct ofxOilConfig {
+
+	/**
+	 * @brief Returns a shared instance with the default parameters
+	 *
+	 * @return a shared instance with the default parameters
+	 */
+	static shared_ptr<const ofxOilConfig> getDefault();
+
+	/**
+	 * @brief The smaller brush size allowed
+	 */
+	float smallerBrushSize = 4;
+
+	/**
+	 * @brief The brush size decrement ratio
+	 */
+	float brushSizeDecrement = 1.3;
+
+	/**
+	 * @brief The initial average brush size. If zero, a sixth of the largest image dimension will be used.
+	 */
+	float initialBrushSize = 0;
+
+	/**
+	 * @brief The maximum number of invalid trajectories allowed before the brush size is reduced
+	 */
+	unsigned int maxInvalidTrajectories = 5000;
+
+	/**
+	 * @brief The maximum number of invalid trajectories allowed for the smaller brush size before the painting is
+	 * finished
+	 */
+	unsigned int maxInvalidTrajectoriesForSmallerSize = 10000;
+
+	/**
+	 * @brief The maximum number of invalid traces allowed before the brush size is reduced
+	 */
+	unsigned int maxInvalidTraces = 250;
+
+	/**
+	 * @brief The maximum number of invalid traces allowed for the smaller brush size before the painting is finished
+	 */
+	unsigned int maxInvalidTracesForSmallerSize = 350;
+
+	/**
+	 * @brief The trace speed in pixels/step
+	 */
+	float traceSpeed = 2;
+
+	/**
+	 * @brief The typical trace length, relative to the brush size
+	 */
+	float relativeTraceLength = 2.3;
+
+	/**
+	 * @brief The minimum trace length allowed
+	 */
+	float minTraceLength = 16;
+
+	/**
+	 * @brief The canvas background color
+	 */
+	ofColor backgroundColor = ofColor(255);
+
+	/**
+	 * @brief The maximum color difference between the painted image and the already painted color to consider it well
+	 * painted
+	 */
+	array<int, 3> maxColorDifference = { 40, 40, 40 };
+
+	/**
+	 * @brief The maximum allowed fraction of pixels in the trace trajectory that have been visited before
+	 */
+	float maxVisitsFractionInTrajectory = 0.35;
+
+	/**
+	 * @brief The minimum fraction of pixels in the trace trajectory that should fall inside the canvas
+	 */
+	float minInsideFractionInTrajectory = 0.4;
+
+	/**
+	 * @brief The maximum allowed fraction of pixels in the trace trajectory with colors similar to the painted image
+	 */
+	float maxSimilarColorFractionInTrajectory = 0.6;
+
+	/**
+	 * @brief The maximum allowed value of the colors standard deviation along the trace trajectory
+	 */
+	float maxColorStdevInTrajectory = 45;
+
+	/**
+	 * @brief Sets if the trace starting pixels should be drawn again when the image colors around them change so much
+	 * that any trajectory starting on them will have a color standard deviation larger than maxColorStdevInTrajectory
+	 */
+	bool seedPrefilter = false;
+
+	/**
+	 * @brief The maximum number of times that a trace starting pixel is drawn when the seed prefilter is used. The
+	 * trajectory of the last drawn pixel is always created and checked.
+	 */
+	unsigned int seedPrefilterAttempts = 10;
+
+	/**
+	 * @brief Sets if the trace starting pixels should be drawn with importance sampling, favoring the image regions
+	 * that are flat at the brush scale and far from the image edges
+	 */
+	bool importanceSampling = false;
+
+	/**
+	 * @brief The minimum luminance gradient of the image edges used by the importance sampling, in luminance units
+	 * per pixel
+	 */
+	float importanceEdgeThreshold = 20;
+
+	/**
+	 * @brief The minimum importance weight of a pixel, so the traces can start anywhere in the image
+	 */
+	float importanceMinWeight = 0.1;
+
+	/**
+	 * @brief The maximum number of bad painted pixels drawn to select the starting pixel of a trace with importance
+	 * sampling. The last drawn pixel is always used.
+	 */
+	unsigned int importanceSamplingAttempts = 8;
+
+	/**
+	 * @brief Sets if the trace starting pixels should be drawn with a probability proportional to their color error,
+	 * instead of uniformly from all the bad painted pixels
+	 */
+	bool errorWeightedSampling = false;
+
+	/**
+	 * @brief The maximum number of traces accepted between two pixel arrays updates. The traces in a batch cannot
+	 * overlap, since they are evaluated with the same pixel arrays.
+	 */
+	unsigned int maxTracesPerUpdate = 1;
+
+	/**
+	 * @brief The maximum number of additional candidates evaluated to complete a batch of traces
+	 */
+	unsigned int maxTraceBatchCandidates = 100;
+
+	/**
+	 * @brief The number of candidates evaluated to find the next trace after each step of a trace painted step by
+	 * step. The search reserves the region of the trace being painted, so the next trace is usually ready when the
+	 * current one is finished. If zero, the next trace is searched only after the current trace is painted.
+	 */
+	unsigned int pipelinedSearchCandidates = 0;
+
+	/**
+	 * @brief The minimum fraction of pixels in the trace that should fall inside the canvas
+	 */
+	float minInsideFraction = 0.7;
+
+	/**
+	 * @brief The maximum fraction of pixels in the trace with colors similar to the painted image
+	 */
+	float maxSimilarColorFraction = 0.8; // 0.8 - 0.85 - 0.5
+
+	/**
+	 * @brief The maximum fraction of pixels in the trace that has been painted already
+	 */
+	float maxPaintedFraction = 0.65;
+
+	/**
+	 * @brief The minimum color improvement factor of the already painted pixels required to paint the trace on the
+	 * canvas
+	 */
+	float minColorImprovementFactor = 0.6;
+
+	/**
+	 * @brief The minimum improvement fraction in the number of well painted pixels to consider to paint the trace even
+	 * if there is not a significant color improvement
+	 */
+	float bigWellPaintedImprovementFraction = 0.3; // 0.3 - 0.35 - 0.4
+
+	/**
+	 * @brief The minimum reduction fraction in the number of bad painted pixels required to paint the trace on the
+	 * canvas
+	 */
+	float minBadPaintedReductionFraction = 0.45; // 0.45 - 0.3 - 0.45
+
+	/**
+	 * @brief The maximum allowed fraction of pixels in the trace that were previously well painted and will be now bad
+	 * painted
+	 */
+	float maxWellPaintedDestructionFraction = 0.4; // 0.4 - 0.55 - 0.4
+
+	/**
+	 * @brief Sets how random the trace movement is
+	 */
+	float noiseFactor = 0.007;
+
+	/**
+	 * @brief The minimum alpha value to be considered for the trace average color calculation
+	 */
+	unsigned char minAlpha = 20;
+
+	/**
+	 * @brief The brightness relative change range between the bristles colors
+	 */
+	float brightnessRelativeChange = 0.09;
+
+	/**
+	 * @brief The typical trajectory step when the color mixing starts
+	 */
+	unsigned int typicalMixStartingStep = 5;
+
+	/**
+	 * @brief The color mixing strength
+	 */
+	float mixStrength = 0.012;
+
+	/**
+	 * @brief The maximum bristle length
+	 */
+	float maxBristleLength = 15;
+
+	/**
+	 * @brief The maximum bristle thickness
+	 */
+	float maxBristleThickness = 5;
+
+	/**
+	 * @brief The maximum noise range to add in each update to the bristles horizontal position on the brush
+	 */
+	float maxBristleHorizontalNoise = 4;
+
+	/**
+	 * @brief The noise range to add to the bristles vertical position on the brush
+	 */
+	float bristleVerticalNoise = 8;
+
+	/**
+	 * @brief Controls the bristles horizontal noise speed
+	 */
+	float noiseSpeedFactor = 0.04;
+
+	/**
+	 * @brief The number of positions to use to calculate the brush average position
+	 */
+	unsigned int positionsForAverage = 4;
+
+	/**
+	 * @brief The size of the square blocks used to compare consecutive video frames
+	 */
+	unsigned int videoBlockSize = 16;
+
+	/**
+	 * @brief The minimum average color channel difference between two video frames for a block to be repainted
+	 */
+	float videoChangeThreshold = 10;
+};
@@ -0,0 +1,64 @@
+#include "ofxOilFboCanvas.h"
+#include "ofMain.h"
+
+ofxOilFboCanvas::ofxOilFboCanvas(int _numSamples) :
+		numSamples(_numSamples) {
+}
+
+void ofxOilFboCanvas::allocate(int width, int height, const ofColor& backgroundColor) {
+	fbo.allocate(width, height, GL_RGB, numSamples);
+	fbo.begin();
+	ofClear(backgroundColor);
+	fbo.end();
+}
+
+void ofxOilFboCanvas::setPixels(const ofPixels& newPixels) {
+	// Draw the pixels on the fbo using a temporary texture
+	ofTexture texture;
+	texture.loadData(newPixels);
+	fbo.allocate(newPixels.getWidth(), newPixels.getHeight(), GL_RGB, numSamples);
+	fbo.begin();
+	ofPushStyle();
+	ofSetColor(255);
+	texture.draw(0, 0);
+	ofPopStyle();
+	fbo.end();
+	pixels = newPixels;
+}
+
+void ofxOilFboCanvas::begin() {
+	fbo.begin();
+	ofPushStyle();
+}
+
+void ofxOilFboCanvas::end() {
+	ofPopStyle();
+	fbo.end();
+}
+
+void ofxOilFboCanvas::drawLine(const glm::vec2& startPos, const glm::vec2& endPos, float width,
+		const ofColor& color) {
+	ofSetColor(color);
+	ofSetLineWidth(width);
+	ofDrawLine(startPos.x, startPos.y, 0, endPos.x, endPos.y, 0);
+}
+
+void ofxOilFboCanvas::updatePixels() {
+	fbo.readToPixels(pixels);
+}
+
+const ofPixels& ofxOilFboCanvas::getPixels() const {
+	return pixels;
+}
+
+void ofxOilFboCanvas::draw(float x, float y) const {
+	fbo.draw(x, y);
+}
+
+int ofxOilFboCanvas::getWidth() const {
+	return fbo.getWidth();
+}
+
+int ofxOilFboCanvas::getHeight() const {
+	return fbo.getHeight();
+}
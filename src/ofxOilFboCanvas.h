@@ -0,0 +1,60 @@
+#pragma once
+
+#include "ofMain.h"
+#include "ofxOilCanvas.h"
+
+/**
+ * @brief Canvas that is painted on the GPU using an ofFbo
+ *
+ * @author Javier Graciá Carpio
+ */
+class ofxOilFboCanvas: public ofxOilCanvas {
+public:
+
+	/**
+	 * @brief Constructor
+	 *
+	 * @param _numSamples the number of samples used for antialiasing
+	 */
+	ofxOilFboCanvas(int _numSamples = 0);
+
+	void allocate(int width, int height, const ofColor& backgroundColor) override;
+
+	void setPixels(const ofPixels& newPixels) override;
+
+	void begin() override;
+
+	void end() override;
+
+	void drawLine(const glm::vec2& startPos, const glm::vec2& endPos, float width, const ofColor& color) override;
+
+	/**
+	 * @brief Reads the fbo pixels back from the GPU
+	 */
+	void updatePixels() override;
+
+	const ofPixels& getPixels() const override;
+
+	void draw(float x, float y) const override;
+
+	int getWidth() const override;
+
+	int getHeight() const override;
+
+protected:
+
+	/**
+	 * @brief The number of samples used for antialiasing
+	 */
+	int numSamples;
+
+	/**
+	 * @brief The fbo where the painting is done
+	 */
+	ofFbo fbo;
+
+	/**
+	 * @brief The fbo pixels obtained in the last updatePixels call
+	 */
+	ofPixels pixels;
+};
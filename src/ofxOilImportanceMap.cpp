@@ -0,0 +1,122 @@
+#include "ofxOilImportanceMap.h"
+#include "ofxOilVarianceMap.h"
+#include "ofMain.h"
+
+ofxOilImportanceMap::ofxOilImportanceMap() :
+		brushSize(0) {
+}
+
+void ofxOilImportanceMap::setImage(const ofPixels& pixels, float edgeThreshold) {
+	// Check that the input makes sense
+	if (pixels.getNumChannels() < 3) {
+		throw invalid_argument("The importance map needs pixels with at least three color channels.");
+	}
+
+	int width = pixels.getWidth();
+	int height = pixels.getHeight();
+	int nChannels = pixels.getNumChannels();
+	const unsigned char* data = pixels.getData();
+
+	// Calculate the pixel luminances
+	vector<float> luminances(size_t(width) * height);
+
+	for (size_t i = 0, nPixels = luminances.size(); i < nPixels; ++i) {
+		const unsigned char* color = data + i * nChannels;
+		luminances[i] = 0.299f * color[0] + 0.587f * color[1] + 0.114f * color[2];
+	}
+
+	// Mark the edges with the Sobel operator, normalized to the luminance change per pixel. The edge pixels have a
+	// zero distance and the rest an infinite distance.
+	edgeDistances.assign(luminances.size(), numeric_limits<float>::infinity());
+	auto lum = [&luminances, width](int x, int y) {
+		return luminances[size_t(y) * width + x];
+	};
+
+	for (int y = 1; y < height - 1; ++y) {
+		for (int x = 1; x < width - 1; ++x) {
+			float gx = (lum(x + 1, y - 1) + 2 * lum(x + 1, y) + lum(x + 1, y + 1))
+					- (lum(x - 1, y - 1) + 2 * lum(x - 1, y) + lum(x - 1, y + 1));
+			float gy = (lum(x - 1, y + 1) + 2 * lum(x, y + 1) + lum(x + 1, y + 1))
+					- (lum(x - 1, y - 1) + 2 * lum(x, y - 1) + lum(x + 1, y - 1));
+
+			if (sqrt(gx * gx + gy * gy) / 8 > edgeThreshold) {
+				edgeDistances[size_t(y) * width + x] = 0;
+			}
+		}
+	}
+
+	// Calculate the distance to the closest edge with a two pass chamfer distance transform
+	float diagonal = sqrt(2.0f);
+	auto relax = [this, width, height](float& distance, int x, int y, float step) {
+		if (x >= 0 && x < width && y >= 0 && y < height) {
+			distance = min(distance, edgeDistances[size_t(y) * width + x] + step);
+		}
+	};
+
+	for (int y = 0; y < height; ++y) {
+		for (int x = 0; x < width; ++x) {
+			float& distance = edgeDistances[size_t(y) * width + x];
+			relax(distance, x - 1, y, 1);
+			relax(distance, x, y - 1, 1);
+			relax(distance, x - 1, y - 1, diagonal);
+			relax(distance, x + 1, y - 1, diagonal);
+		}
+	}
+
+	for (int y = height - 1; y >= 0; --y) {
+		for (int x = width - 1; x >= 0; --x) {
+			float& distance = edgeDistances[size_t(y) * width + x];
+			relax(distance, x + 1, y, 1);
+			relax(distance, x, y + 1, 1);
+			relax(distance, x + 1, y + 1, diagonal);
+			relax(distance, x - 1, y + 1, diagonal);
+		}
+	}
+
+	// The weights should be calculated again
+	brushSize = 0;
+	weights.clear();
+}
+
+void ofxOilImportanceMap::calculate(const ofxOilVarianceMap& varianceMap, float _brushSize, float maxStdev,
+		float minWeight) {
+	// Check that the image edges have been calculated
+	if (!hasImage()) {
+		throw logic_error("Please, set the image before calculating the importance map.");
+	}
+
+	brushSize = _brushSize;
+	weights.resize(edgeDistances.size());
+	float halfBrushSize = max(0.5f * brushSize, 1.0f);
+	minWeight = ofClamp(minWeight, 0, 1);
+
+	for (size_t i = 0, nPixels = weights.size(); i < nPixels; ++i) {
+		// Traces covering an edge tend to be rejected
+		float edgeWeight = min(edgeDistances[i] / halfBrushSize, 1.0f);
+
+		// Traces in busy regions tend to be rejected
+		float stdevRatio = varianceMap.getStdev(i) / maxStdev;
+		float flatnessWeight = 1 / (1 + stdevRatio * stdevRatio);
+
+		// Combine the weights, making sure that all the pixels can still be selected
+		weights[i] = 255 * (minWeight + (1 - minWeight) * edgeWeight * flatnessWeight);
+	}
+}
+
+void ofxOilImportanceMap::clear() {
+	edgeDistances.clear();
+	brushSize = 0;
+	weights.clear();
+}
+
+bool ofxOilImportanceMap::hasImage() const {
+	return !edgeDistances.empty();
+}
+
+float ofxOilImportanceMap::getBrushSize() const {
+	return brushSize;
+}
+
+float ofxOilImportanceMap::getWeight(unsigned int pixel) const {
+	return weights[pixel] / 255.0f;
+}
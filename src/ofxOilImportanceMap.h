@@ -0,0 +1,88 @@
+#pragma once
+
+#include "ofMain.h"
+#include "ofxOilVarianceMap.h"
+
+/**
+ * @brief Class used to calculate the importance of each image pixel as a trace starting pixel for a given brush size
+ *
+ * Traces of a given size are most likely accepted when they start in regions that are flat at the brush scale and far
+ * from the image edges. The edges are the pixels with a large luminance gradient, and their distance to every pixel is
+ * calculated once for each image. The pixel weights combine the edge distance relative to the brush size with the
+ * local color standard deviation obtained from a variance map, and they are calculated once for each brush size. The
+ * simulator uses them to draw the trace starting pixels with rejection sampling.
+ *
+ * @author Javier Graciá Carpio
+ */
+class ofxOilImportanceMap {
+public:
+
+	/**
+	 * @brief Constructor
+	 */
+	ofxOilImportanceMap();
+
+	/**
+	 * @brief Calculates the image edges and the distance from each pixel to the closest edge
+	 *
+	 * @param pixels the image pixels. Only the first three color channels are used.
+	 * @param edgeThreshold the minimum luminance gradient of the edge pixels, in luminance units per pixel
+	 */
+	void setImage(const ofPixels& pixels, float edgeThreshold);
+
+	/**
+	 * @brief Calculates the pixel weights for a given brush size
+	 *
+	 * Note that the setImage method should have been run before.
+	 *
+	 * @param varianceMap the image variance map, calculated with a box similar to the brush size
+	 * @param _brushSize the average brush size
+	 * @param maxStdev the color standard deviation where the flatness weight falls to one half
+	 * @param minWeight the minimum pixel weight, so all the pixels can be selected
+	 */
+	void calculate(const ofxOilVarianceMap& varianceMap, float _brushSize, float maxStdev, float minWeight);
+
+	/**
+	 * @brief Removes the image edges and the calculated weights
+	 */
+	void clear();
+
+	/**
+	 * @brief Checks if the image edges have been calculated
+	 *
+	 * @return true if the image edges have been calculated
+	 */
+	bool hasImage() const;
+
+	/**
+	 * @brief Returns the brush size used to calculate the pixel weights
+	 *
+	 * @return the brush size. It is zero if the weights have not been calculated.
+	 */
+	float getBrushSize() const;
+
+	/**
+	 * @brief Returns the weight of a pixel
+	 *
+	 * @param pixel the pixel index (y * width + x)
+	 * @return the pixel weight, between the minimum weight and 1
+	 */
+	float getWeight(unsigned int pixel) const;
+
+protected:
+
+	/**
+	 * @brief The distance from each pixel to the closest image edge in pixels
+	 */
+	vector<float> edgeDistances;
+
+	/**
+	 * @brief The brush size used to calculate the pixel weights
+	 */
+	float brushSize;
+
+	/**
+	 * @brief The pixel weights, scaled to the [0, 255] range
+	 */
+	vector<unsigned char> weights;
+};
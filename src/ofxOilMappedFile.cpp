@@ -0,0 +1,127 @@
+#include "ofxOilMappedFile.h"
+#include "ofMain.h"
+
+#ifdef TARGET_WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+ofxOilMappedFile::ofxOilMappedFile() {
+	data = nullptr;
+	size = 0;
+#ifdef TARGET_WIN32
+	fileHandle = nullptr;
+	mappingHandle = nullptr;
+#endif
+}
+
+ofxOilMappedFile::~ofxOilMappedFile() {
+	close();
+}
+
+void ofxOilMappedFile::open(const string& path) {
+	// Unmap the previous file if necessary
+	close();
+	string fullPath = ofToDataPath(path, true);
+
+#ifdef TARGET_WIN32
+	// Open the file and get its size
+	HANDLE file = CreateFileA(fullPath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+			FILE_ATTRIBUTE_NORMAL, nullptr);
+	LARGE_INTEGER fileSize;
+
+	if (file == INVALID_HANDLE_VALUE) {
+		throw runtime_error("The file " + fullPath + " could not be opened.");
+	} else if (!GetFileSizeEx(file, &fileSize)) {
+		CloseHandle(file);
+		throw runtime_error("The size of the file " + fullPath + " could not be obtained.");
+	}
+
+	fileHandle = file;
+	size = fileSize.QuadPart;
+
+	// Empty files cannot be mapped
+	if (size == 0) {
+		return;
+	}
+
+	// Map the file
+	mappingHandle = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+
+	if (mappingHandle != nullptr) {
+		data = static_cast<const unsigned char*>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0));
+	}
+
+	if (data == nullptr) {
+		close();
+		throw runtime_error("The file " + fullPath + " could not be mapped in memory.");
+	}
+#else
+	// Open the file and get its size
+	int file = ::open(fullPath.c_str(), O_RDONLY);
+	struct stat fileStat;
+
+	if (file < 0) {
+		throw runtime_error("The file " + fullPath + " could not be opened.");
+	} else if (fstat(file, &fileStat) != 0) {
+		::close(file);
+		throw runtime_error("The size of the file " + fullPath + " could not be obtained.");
+	}
+
+	size = fileStat.st_size;
+
+	// Empty files cannot be mapped
+	if (size == 0) {
+		::close(file);
+		return;
+	}
+
+	// Map the file. The mapping is still valid after closing the file descriptor.
+	void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, file, 0);
+	::close(file);
+
+	if (mapping == MAP_FAILED) {
+		size = 0;
+		throw runtime_error("The file " + fullPath + " could not be mapped in memory.");
+	}
+
+	data = static_cast<const unsigned char*>(mapping);
+#endif
+}
+
+void ofxOilMappedFile::close() {
+#ifdef TARGET_WIN32
+	if (data != nullptr) {
+		UnmapViewOfFile(data);
+	}
+
+	if (mappingHandle != nullptr) {
+		CloseHandle(mappingHandle);
+		mappingHandle = nullptr;
+	}
+
+	if (fileHandle != nullptr) {
+		CloseHandle(fileHandle);
+		fileHandle = nullptr;
+	}
+#else
+	if (data != nullptr) {
+		munmap(const_cast<unsigned char*>(data), size);
+	}
+#endif
+
+	data = nullptr;
+	size = 0;
+}
+
+const unsigned char* ofxOilMappedFile::getData() const {
+	return data;
+}
+
+size_t ofxOilMappedFile::getSize() const {
+	return size;
+}
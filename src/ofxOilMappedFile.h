@@ -0,0 +1,85 @@
+#pragma once
+
+#include "ofMain.h"
+
+/**
+ * @brief Class used to map a file in memory for reading
+ *
+ * The file content is loaded by the operating system only when it is accessed, so large files can be read without
+ * copying them to memory first.
+ *
+ * @author Javier Graciá Carpio
+ */
+class ofxOilMappedFile {
+public:
+
+	/**
+	 * @brief Constructor
+	 */
+	ofxOilMappedFile();
+
+	/**
+	 * @brief Destructor. Unmaps the file.
+	 */
+	~ofxOilMappedFile();
+
+	/**
+	 * @brief Deleted copy constructor, since the mapping cannot be shared
+	 */
+	ofxOilMappedFile(const ofxOilMappedFile&) = delete;
+
+	/**
+	 * @brief Deleted copy assignment operator, since the mapping cannot be shared
+	 */
+	ofxOilMappedFile& operator=(const ofxOilMappedFile&) = delete;
+
+	/**
+	 * @brief Maps a file in memory, unmapping the previous one if necessary
+	 *
+	 * @param path the file path
+	 */
+	void open(const string& path);
+
+	/**
+	 * @brief Unmaps the file
+	 */
+	void close();
+
+	/**
+	 * @brief Returns a pointer to the mapped file content
+	 *
+	 * @return a pointer to the mapped file content, or nullptr if no file is mapped or the file is empty
+	 */
+	const unsigned char* getData() const;
+
+	/**
+	 * @brief Returns the mapped file size in bytes
+	 *
+	 * @return the mapped file size in bytes
+	 */
+	size_t getSize() const;
+
+protected:
+
+	/**
+	 * @brief The mapped file content
+	 */
+	const unsigned char* data;
+
+	/**
+	 * @brief The mapped file size in bytes
+	 */
+	size_t size;
+
+#ifdef TARGET_WIN32
+	/**
+	 * @brief The file handle
+	 */
+	void* fileHandle;
+
+	/**
+	 * @brief The file mapping handle
+	 */
+	void* mappingHandle;
+#endif
+};
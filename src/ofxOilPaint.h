@@ -1,6 +1,29 @@
 #pragma once
 
+#include "ofxOilConfig.h"
+#include "ofxOilSimulatorStats.h"
+#include "ofxOilRandom.h"
+#include "ofxOilThreadPool.h"
+#include "ofxOilSimilarityKernel.h"
+#include "ofxOilVarianceMap.h"
+#include "ofxOilStdevBoundMap.h"
+#include "ofxOilImportanceMap.h"
+#include "ofxOilWeightedSampler.h"
+#include "ofxOilBitMask.h"
+#include "ofxOilCanvas.h"
+#include "ofxOilFboCanvas.h"
+#include "ofxOilPixelsCanvas.h"
+#include "ofxOilScaledCanvas.h"
 #include "ofxOilBristle.h"
 #include "ofxOilBrush.h"
 #include "ofxOilTrace.h"
 #include "ofxOilSimulator.h"
+#include "ofxOilTiledSimulator.h"
+#include "ofxOilMappedFile.h"
+#include "ofxOilTiledPixels.h"
+#include "ofxOilStrokeLogWriter.h"
+#include "ofxOilStrokeLogReader.h"
+#include "ofxOilStrokeTimeline.h"
+#include "ofxOilBatchRenderer.h"
+#include "ofxOilRingBuffer.h"
+#include "ofxOilVideoPainter.h"
@@ -0,0 +1,102 @@
+#include "ofxOilPixelsCanvas.h"
+#include "ofMain.h"
+
+ofxOilPixelsCanvas::ofxOilPixelsCanvas() {
+	textureNeedsUpdate = true;
+}
+
+void ofxOilPixelsCanvas::allocate(int width, int height, const ofColor& backgroundColor) {
+	pixels.allocate(width, height, OF_PIXELS_RGB);
+	pixels.setColor(backgroundColor);
+	textureNeedsUpdate = true;
+}
+
+void ofxOilPixelsCanvas::setPixels(const ofPixels& newPixels) {
+	pixels = newPixels;
+	pixels.setImageType(OF_IMAGE_COLOR);
+	textureNeedsUpdate = true;
+}
+
+void ofxOilPixelsCanvas::begin() {
+}
+
+void ofxOilPixelsCanvas::end() {
+	textureNeedsUpdate = true;
+}
+
+void ofxOilPixelsCanvas::drawLine(const glm::vec2& startPos, const glm::vec2& endPos, float width,
+		const ofColor& color) {
+	// Lines thinner than one pixel are painted with one pixel width and a proportionally lower alpha
+	float radius = 0.5 * max(width, 1.0f);
+	float alpha = (color.a / 255.0) * min(width, 1.0f);
+
+	if (alpha <= 0) {
+		return;
+	}
+
+	// Calculate the pixels range that could be covered by the line
+	int canvasWidth = pixels.getWidth();
+	int canvasHeight = pixels.getHeight();
+	float reach = radius + 0.5;
+	int xMin = max(0, (int) floor(min(startPos.x, endPos.x) - reach));
+	int yMin = max(0, (int) floor(min(startPos.y, endPos.y) - reach));
+	int xMax = min(canvasWidth - 1, (int) ceil(max(startPos.x, endPos.x) + reach));
+	int yMax = min(canvasHeight - 1, (int) ceil(max(startPos.y, endPos.y) + reach));
+
+	// Precalculate the segment direction
+	float dx = endPos.x - startPos.x;
+	float dy = endPos.y - startPos.y;
+	float lengthSq = dx * dx + dy * dy;
+	float invLengthSq = lengthSq > 0 ? 1 / lengthSq : 0;
+
+	// Blend the line color with the canvas colors
+	unsigned int nChannels = pixels.getNumChannels();
+	unsigned char* data = pixels.getData();
+
+	for (int y = yMin; y <= yMax; ++y) {
+		for (int x = xMin; x <= xMax; ++x) {
+			// Calculate the distance from the pixel center to the segment
+			float px = x + 0.5 - startPos.x;
+			float py = y + 0.5 - startPos.y;
+			float t = ofClamp((px * dx + py * dy) * invLengthSq, 0, 1);
+			float distX = px - t * dx;
+			float distY = py - t * dy;
+			float dist = sqrt(distX * distX + distY * distY);
+
+			// Calculate the pixel coverage
+			float coverage = ofClamp(reach - dist, 0, 1);
+
+			if (coverage > 0) {
+				float f = alpha * coverage;
+				unsigned char* pix = data + (x + y * canvasWidth) * nChannels;
+				pix[0] = round(pix[0] + f * (color.r - pix[0]));
+				pix[1] = round(pix[1] + f * (color.g - pix[1]));
+				pix[2] = round(pix[2] + f * (color.b - pix[2]));
+			}
+		}
+	}
+}
+
+void ofxOilPixelsCanvas::updatePixels() {
+}
+
+const ofPixels& ofxOilPixelsCanvas::getPixels() const {
+	return pixels;
+}
+
+void ofxOilPixelsCanvas::draw(float x, float y) const {
+	if (textureNeedsUpdate) {
+		texture.loadData(pixels);
+		textureNeedsUpdate = false;
+	}
+
+	texture.draw(x, y);
+}
+
+int ofxOilPixelsCanvas::getWidth() const {
+	return pixels.getWidth();
+}
+
+int ofxOilPixelsCanvas::getHeight() const {
+	return pixels.getHeight();
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include "ofMain.h"
+#include "ofxOilCanvas.h"
+
+/**
+ * @brief Canvas that is painted on the CPU using an ofPixels container
+ *
+ * The lines are rasterized in software with antialiased edges, so no OpenGL context is needed to paint on it. The
+ * painted pixels can be accessed directly, without any readback from the GPU.
+ *
+ * @author Javier Graciá Carpio
+ */
+class ofxOilPixelsCanvas: public ofxOilCanvas {
+public:
+
+	/**
+	 * @brief Constructor
+	 */
+	ofxOilPixelsCanvas();
+
+	void allocate(int width, int height, const ofColor& backgroundColor) override;
+
+	void setPixels(const ofPixels& newPixels) override;
+
+	void begin() override;
+
+	void end() override;
+
+	/**
+	 * @brief Draws a line segment on the canvas
+	 *
+	 * The line is rasterized as a segment with rounded ends. The pixel coverage is calculated from the distance to
+	 * the segment and it is used to blend the line color with the canvas color.
+	 *
+	 * @param startPos the line start position
+	 * @param endPos the line end position
+	 * @param width the line width
+	 * @param color the line color
+	 */
+	void drawLine(const glm::vec2& startPos, const glm::vec2& endPos, float width, const ofColor& color) override;
+
+	/**
+	 * @brief Does nothing, since the canvas pixels are always up to date
+	 */
+	void updatePixels() override;
+
+	const ofPixels& getPixels() const override;
+
+	/**
+	 * @brief Draws the canvas on the screen
+	 *
+	 * Note that this method requires an OpenGL context.
+	 *
+	 * @param x the screen x position
+	 * @param y the screen y position
+	 */
+	void draw(float x, float y) const override;
+
+	int getWidth() const override;
+
+	int getHeight() const override;
+
+protected:
+
+	/**
+	 * @brief The canvas pixels
+	 */
+	ofPixels pixels;
+
+	/**
+	 * @brief The texture used to draw the canvas on the screen
+	 */
+	mutable ofTexture texture;
+
+	/**
+	 * @brief Indicates if the texture should be updated with the canvas pixels before drawing it
+	 */
+	mutable bool textureNeedsUpdate;
+};
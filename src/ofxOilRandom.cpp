@@ -0,0 +1,42 @@
+#include "ofxOilRandom.h"
+#include "ofMain.h"
+
+ofxOilRandom::ofxOilRandom(uint64_t _key, uint64_t _counter) :
+		key(_key), counter(_counter) {
+}
+
+ofxOilRandom ofxOilRandom::derive(uint64_t streamId) const {
+	return ofxOilRandom(mix(key ^ mix(streamId + 0x632BE59BD9B4E019ULL)));
+}
+
+uint64_t ofxOilRandom::nextUInt64() {
+	++counter;
+	return mix(key + counter * 0x9E3779B97F4A7C15ULL);
+}
+
+float ofxOilRandom::nextFloat(float max) {
+	// Use the 24 highest bits to fill the float mantissa
+	return max * ((nextUInt64() >> 40) * (1.0f / 16777216.0f));
+}
+
+float ofxOilRandom::nextFloat(float min, float max) {
+	return min + nextFloat(max - min);
+}
+
+unsigned int ofxOilRandom::nextIndex(unsigned int n) {
+	return ((nextUInt64() >> 32) * n) >> 32;
+}
+
+uint64_t ofxOilRandom::getKey() const {
+	return key;
+}
+
+uint64_t ofxOilRandom::getCounter() const {
+	return counter;
+}
+
+uint64_t ofxOilRandom::mix(uint64_t x) {
+	x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+	x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+	return x ^ (x >> 31);
+}
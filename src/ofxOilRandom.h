@@ -0,0 +1,100 @@
+#pragma once
+
+#include "ofMain.h"
+
+/**
+ * @brief Counter-based random number generator
+ *
+ * Each generated number is obtained hashing the stream key together with a counter, so the generator state is just
+ * two integers. Independent sub-streams can be derived from any stream. They are used to give each simulator, trace,
+ * brush and tile its own random numbers, so parallel runs are reproducible and threads never share a generator.
+ *
+ * @author Javier Graciá Carpio
+ */
+class ofxOilRandom {
+public:
+
+	/**
+	 * @brief Constructor
+	 *
+	 * @param _key the stream key (the seed)
+	 * @param _counter the stream counter
+	 */
+	ofxOilRandom(uint64_t _key = 0, uint64_t _counter = 0);
+
+	/**
+	 * @brief Returns a new independent stream derived from this stream
+	 *
+	 * The derived stream only depends on this stream key and the stream id, not on the counter.
+	 *
+	 * @param streamId the derived stream id
+	 * @return the derived stream
+	 */
+	ofxOilRandom derive(uint64_t streamId) const;
+
+	/**
+	 * @brief Returns the next random 64 bits integer
+	 *
+	 * @return the next random 64 bits integer
+	 */
+	uint64_t nextUInt64();
+
+	/**
+	 * @brief Returns the next random float between 0 (included) and max (not included)
+	 *
+	 * @param max the maximum value
+	 * @return the next random float
+	 */
+	float nextFloat(float max = 1);
+
+	/**
+	 * @brief Returns the next random float between min (included) and max (not included)
+	 *
+	 * @param min the minimum value
+	 * @param max the maximum value
+	 * @return the next random float
+	 */
+	float nextFloat(float min, float max);
+
+	/**
+	 * @brief Returns the next random index between 0 (included) and n (not included)
+	 *
+	 * @param n the number of possible indices
+	 * @return the next random index
+	 */
+	unsigned int nextIndex(unsigned int n);
+
+	/**
+	 * @brief Returns the stream key
+	 *
+	 * @return the stream key
+	 */
+	uint64_t getKey() const;
+
+	/**
+	 * @brief Returns the stream counter
+	 *
+	 * @return the number of random numbers generated by the stream
+	 */
+	uint64_t getCounter() const;
+
+protected:
+
+	/**
+	 * @brief Mixes the bits of a 64 bits integer (splitmix64 finalizer)
+	 *
+	 * @param x the integer to mix
+	 * @return the mixed integer
+	 */
+	static uint64_t mix(uint64_t x);
+
+	/**
+	 * @brief The stream key
+	 */
+	uint64_t key;
+
+	/**
+	 * @brief The stream counter
+	 */
+	uint64_t counter;
+};
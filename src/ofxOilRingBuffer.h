@@ -0,0 +1,174 @@
+#pragma once
+
+#include "ofMain.h"
+
+/**
+ * @brief Bounded first-in first-out buffer used to pass elements between threads
+ *
+ * The push method blocks while the buffer is full and the pop method blocks while the buffer is empty. Closing the
+ * buffer wakes up all the waiting threads: no more elements can be pushed, but the remaining elements can still be
+ * popped.
+ *
+ * @author Javier Graciá Carpio
+ */
+template<typename T>
+class ofxOilRingBuffer {
+public:
+
+	/**
+	 * @brief Constructor
+	 *
+	 * @param capacity the maximum number of elements that the buffer can contain
+	 */
+	ofxOilRingBuffer(unsigned int capacity = 4) :
+			elements(max(capacity, 1u)) {
+		head = 0;
+		nElements = 0;
+		closed = false;
+	}
+
+	/**
+	 * @brief Adds an element at the end of the buffer, waiting until there is space for it
+	 *
+	 * @param element the element to add
+	 * @return false if the buffer was closed and the element could not be added
+	 */
+	bool push(T&& element) {
+		unique_lock<mutex> lock(bufferMutex);
+		notFull.wait(lock, [this] {return closed || nElements < elements.size();});
+
+		if (closed) {
+			return false;
+		}
+
+		elements[(head + nElements) % elements.size()] = move(element);
+		++nElements;
+		lock.unlock();
+		notEmpty.notify_one();
+		return true;
+	}
+
+	/**
+	 * @brief Removes the first element of the buffer, waiting until there is one available
+	 *
+	 * @param element the variable where the element will be moved
+	 * @return false if the buffer was closed and there are no elements left
+	 */
+	bool pop(T& element) {
+		unique_lock<mutex> lock(bufferMutex);
+		notEmpty.wait(lock, [this] {return closed || nElements > 0;});
+		return popElement(element, lock);
+	}
+
+	/**
+	 * @brief Removes the first element of the buffer if there is one available, without waiting
+	 *
+	 * @param element the variable where the element will be moved
+	 * @return false if the buffer is empty
+	 */
+	bool tryPop(T& element) {
+		unique_lock<mutex> lock(bufferMutex);
+		return popElement(element, lock);
+	}
+
+	/**
+	 * @brief Closes the buffer, waking up all the threads waiting to push or pop elements
+	 */
+	void close() {
+		{
+			lock_guard<mutex> lock(bufferMutex);
+			closed = true;
+		}
+
+		notFull.notify_all();
+		notEmpty.notify_all();
+	}
+
+	/**
+	 * @brief Removes all the elements and opens the buffer again
+	 */
+	void reset() {
+		lock_guard<mutex> lock(bufferMutex);
+		elements.assign(elements.size(), T());
+		head = 0;
+		nElements = 0;
+		closed = false;
+	}
+
+	/**
+	 * @brief Returns the number of elements in the buffer
+	 *
+	 * @return the number of elements in the buffer
+	 */
+	unsigned int size() const {
+		lock_guard<mutex> lock(bufferMutex);
+		return nElements;
+	}
+
+	/**
+	 * @brief Indicates if the buffer is closed and all its elements have been popped
+	 *
+	 * @return true if the buffer is closed and empty
+	 */
+	bool isDrained() const {
+		lock_guard<mutex> lock(bufferMutex);
+		return closed && nElements == 0;
+	}
+
+protected:
+
+	/**
+	 * @brief Removes the first element of the buffer if there is one available
+	 *
+	 * @param element the variable where the element will be moved
+	 * @param lock the lock of the buffer mutex. It will be unlocked before notifying the waiting threads.
+	 * @return false if the buffer is empty
+	 */
+	bool popElement(T& element, unique_lock<mutex>& lock) {
+		if (nElements == 0) {
+			return false;
+		}
+
+		element = move(elements[head]);
+		head = (head + 1) % elements.size();
+		--nElements;
+		lock.unlock();
+		notFull.notify_one();
+		return true;
+	}
+
+	/**
+	 * @brief The buffer elements
+	 */
+	vector<T> elements;
+
+	/**
+	 * @brief The position of the first element
+	 */
+	unsigned int head;
+
+	/**
+	 * @brief The number of elements in the buffer
+	 */
+	unsigned int nElements;
+
+	/**
+	 * @brief Indicates if the buffer is closed
+	 */
+	bool closed;
+
+	/**
+	 * @brief The mutex protecting the buffer variables
+	 */
+	mutable mutex bufferMutex;
+
+	/**
+	 * @brief Used to notify the threads waiting to push elements that the buffer is not full
+	 */
+	condition_variable notFull;
+
+	/**
+	 * @brief Used to notify the threads waiting to pop elements that the buffer is not empty
+	 */
+	condition_variable notEmpty;
+};
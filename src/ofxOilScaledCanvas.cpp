@@ -0,0 +1,58 @@
+#include "ofxOilScaledCanvas.h"
+#include "ofxOilCanvas.h"
+#include "ofMain.h"
+
+ofxOilScaledCanvas::ofxOilScaledCanvas(unique_ptr<ofxOilCanvas> _canvas, float _scale) :
+		canvas(move(_canvas)), scale(_scale) {
+	// Check that the input makes sense
+	if (!canvas) {
+		throw invalid_argument("The scaled canvas needs a canvas to paint on.");
+	} else if (scale <= 0) {
+		throw invalid_argument("The scale factor should be positive.");
+	}
+}
+
+void ofxOilScaledCanvas::allocate(int width, int height, const ofColor& backgroundColor) {
+	canvas->allocate(round(width * scale), round(height * scale), backgroundColor);
+}
+
+void ofxOilScaledCanvas::setPixels(const ofPixels& newPixels) {
+	canvas->setPixels(newPixels);
+}
+
+void ofxOilScaledCanvas::begin() {
+	canvas->begin();
+}
+
+void ofxOilScaledCanvas::end() {
+	canvas->end();
+}
+
+void ofxOilScaledCanvas::drawLine(const glm::vec2& startPos, const glm::vec2& endPos, float width,
+		const ofColor& color) {
+	canvas->drawLine(scale * startPos, scale * endPos, scale * width, color);
+}
+
+void ofxOilScaledCanvas::updatePixels() {
+	canvas->updatePixels();
+}
+
+const ofPixels& ofxOilScaledCanvas::getPixels() const {
+	return canvas->getPixels();
+}
+
+void ofxOilScaledCanvas::draw(float x, float y) const {
+	canvas->draw(x, y);
+}
+
+int ofxOilScaledCanvas::getWidth() const {
+	return canvas->getWidth();
+}
+
+int ofxOilScaledCanvas::getHeight() const {
+	return canvas->getHeight();
+}
+
+float ofxOilScaledCanvas::getScale() const {
+	return scale;
+}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include "ofMain.h"
+#include "ofxOilCanvas.h"
+
+/**
+ * @brief Canvas that paints on another canvas with all the coordinates and line widths multiplied by a scale factor
+ *
+ * It can be used to paint traces that were obtained on a small canvas at a higher resolution, since the traces don't
+ * need to be modified: their trajectories, brush sizes and bristles are the same, only the rasterization changes.
+ *
+ * @author Javier Graciá Carpio
+ */
+class ofxOilScaledCanvas: public ofxOilCanvas {
+public:
+
+	/**
+	 * @brief Constructor
+	 *
+	 * @param _canvas the canvas where the scaled lines will be painted
+	 * @param _scale the scale factor between the painted coordinates and the canvas coordinates
+	 */
+	ofxOilScaledCanvas(unique_ptr<ofxOilCanvas> _canvas, float _scale);
+
+	/**
+	 * @brief Allocates the canvas and fills it with the background color
+	 *
+	 * The underlying canvas dimensions are the given dimensions multiplied by the scale factor.
+	 *
+	 * @param width the canvas width before scaling
+	 * @param height the canvas height before scaling
+	 * @param backgroundColor the canvas background color
+	 */
+	void allocate(int width, int height, const ofColor& backgroundColor) override;
+
+	/**
+	 * @brief Allocates the canvas and fills it with the given pixels
+	 *
+	 * @param newPixels the new canvas pixels, with the dimensions of the underlying canvas
+	 */
+	void setPixels(const ofPixels& newPixels) override;
+
+	void begin() override;
+
+	void end() override;
+
+	/**
+	 * @brief Draws a line segment on the underlying canvas, scaling its positions and width
+	 *
+	 * @param startPos the line start position
+	 * @param endPos the line end position
+	 * @param width the line width
+	 * @param color the line color
+	 */
+	void drawLine(const glm::vec2& startPos, const glm::vec2& endPos, float width, const ofColor& color) override;
+
+	void updatePixels() override;
+
+	const ofPixels& getPixels() const override;
+
+	void draw(float x, float y) const override;
+
+	/**
+	 * @brief Returns the underlying canvas width
+	 *
+	 * @return the underlying canvas width
+	 */
+	int getWidth() const override;
+
+	/**
+	 * @brief Returns the underlying canvas height
+	 *
+	 * @return the underlying canvas height
+	 */
+	int getHeight() const override;
+
+	/**
+	 * @brief Returns the scale factor
+	 *
+	 * @return the scale factor
+	 */
+	float getScale() const;
+
+protected:
+
+	/**
+	 * @brief The canvas where the scaled lines are painted
+	 */
+	unique_ptr<ofxOilCanvas> canvas;
+
+	/**
+	 * @brief The scale factor between the painted coordinates and the canvas coordinates
+	 */
+	float scale;
+};
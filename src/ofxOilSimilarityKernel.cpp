@@ -0,0 +1,163 @@
+#include "ofxOilSimilarityKernel.h"
+#include "ofMain.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define OFX_OIL_SIMILARITY_AVX2
+#define OFX_OIL_SIMILARITY_SSSE3
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define OFX_OIL_SIMILARITY_SSE2
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+#define OFX_OIL_SIMILARITY_SSSE3
+#endif
+#endif
+
+void ofxOilSimilarityKernel::calculateBadPaintedMask(const unsigned char* imgPixels,
+		const unsigned char* paintedPixels, unsigned int nPixels, const ofColor& backgroundColor,
+		const array<int, 3>& maxColorDifference, unsigned char* mask) {
+	// No pixel can be well painted if one of the maximum color differences is not positive
+	if (maxColorDifference[0] <= 0 || maxColorDifference[1] <= 0 || maxColorDifference[2] <= 0) {
+		memset(mask, 255, nPixels);
+		return;
+	}
+
+	unsigned int pixel = 0;
+
+#if defined(OFX_OIL_SIMILARITY_AVX2) || defined(OFX_OIL_SIMILARITY_SSE2)
+#if defined(OFX_OIL_SIMILARITY_AVX2)
+	typedef __m256i Vector;
+	const unsigned int vectorBytes = 32;
+#else
+	typedef __m128i Vector;
+	const unsigned int vectorBytes = 16;
+#endif
+	// Each block contains three vectors, so the color channels pattern is the same in all the blocks
+	const unsigned int blockPixels = vectorBytes;
+	const unsigned int blockBytes = 3 * vectorBytes;
+	alignas(32) unsigned char maxDiffPattern[blockBytes];
+	alignas(32) unsigned char backgroundPattern[blockBytes];
+
+	for (unsigned int i = 0; i < blockBytes; ++i) {
+		// The comparisons are done with the maximum difference minus one, since there is no unsigned less than
+		maxDiffPattern[i] = min(maxColorDifference[i % 3] - 1, 255);
+		backgroundPattern[i] = backgroundColor[i % 3];
+	}
+
+	Vector maxDiffVectors[3];
+	Vector backgroundVectors[3];
+
+	for (unsigned int j = 0; j < 3; ++j) {
+#if defined(OFX_OIL_SIMILARITY_AVX2)
+		maxDiffVectors[j] = _mm256_load_si256((const Vector*) (maxDiffPattern + j * vectorBytes));
+		backgroundVectors[j] = _mm256_load_si256((const Vector*) (backgroundPattern + j * vectorBytes));
+#else
+		maxDiffVectors[j] = _mm_load_si128((const Vector*) (maxDiffPattern + j * vectorBytes));
+		backgroundVectors[j] = _mm_load_si128((const Vector*) (backgroundPattern + j * vectorBytes));
+#endif
+	}
+
+#if defined(OFX_OIL_SIMILARITY_SSSE3)
+	// Reduces the well painted channel bytes of 16 pixels to one byte per pixel. Each channel byte is combined with
+	// the next two bytes, and the bytes of the first channel of each pixel are moved together with byte shuffles.
+	const __m128i firstChannelIndices = _mm_setr_epi8(0, 3, 6, 9, 12, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1);
+	const __m128i secondChannelIndices = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, 2, 5, 8, 11, 14, -1, -1, -1, -1, -1);
+	const __m128i thirdChannelIndices = _mm_setr_epi8(-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, 1, 4, 7, 10, 13);
+	auto reducePixelChannels = [&](__m128i first, __m128i second, __m128i third) {
+		first = _mm_and_si128(_mm_and_si128(first, _mm_alignr_epi8(second, first, 1)),
+				_mm_alignr_epi8(second, first, 2));
+		second = _mm_and_si128(_mm_and_si128(second, _mm_alignr_epi8(third, second, 1)),
+				_mm_alignr_epi8(third, second, 2));
+		third = _mm_and_si128(_mm_and_si128(third, _mm_srli_si128(third, 1)), _mm_srli_si128(third, 2));
+		return _mm_or_si128(_mm_or_si128(_mm_shuffle_epi8(first, firstChannelIndices),
+				_mm_shuffle_epi8(second, secondChannelIndices)), _mm_shuffle_epi8(third, thirdChannelIndices));
+	};
+#else
+	// Without byte shuffles, the pixels are reduced with the sign bits of the channel bytes, and the pixel bits are
+	// expanded back to bytes comparing them with the bit of each byte position
+	const __m128i bitPattern = _mm_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+	auto reducePixelChannels = [&](__m128i first, __m128i second, __m128i third) {
+		uint64_t bits = uint64_t(_mm_movemask_epi8(first)) | (uint64_t(_mm_movemask_epi8(second)) << 16)
+				| (uint64_t(_mm_movemask_epi8(third)) << 32);
+		bits &= (bits >> 1) & (bits >> 2);
+
+		// Keep every third bit, moving them to consecutive positions
+		bits &= 0x1249249249249249ULL;
+		bits = (bits ^ (bits >> 2)) & 0x10C30C30C30C30C3ULL;
+		bits = (bits ^ (bits >> 4)) & 0x100F00F00F00F00FULL;
+		bits = (bits ^ (bits >> 8)) & 0x001F0000FF0000FFULL;
+		bits = (bits ^ (bits >> 16)) & 0x001F00000000FFFFULL;
+		__m128i expanded = _mm_unpacklo_epi64(_mm_set1_epi8(char(bits)), _mm_set1_epi8(char(bits >> 8)));
+		return _mm_cmpeq_epi8(_mm_and_si128(expanded, bitPattern), bitPattern);
+	};
+#endif
+
+	Vector wellPaintedChannels[3];
+
+	for (; pixel + blockPixels <= nPixels; pixel += blockPixels) {
+		const unsigned char* img = imgPixels + 3 * pixel;
+		const unsigned char* painted = paintedPixels + 3 * pixel;
+
+		// Compare the color channels. The result bytes are 0xFF if the channel is well painted.
+		for (unsigned int j = 0; j < 3; ++j) {
+#if defined(OFX_OIL_SIMILARITY_AVX2)
+			Vector imgVector = _mm256_loadu_si256((const Vector*) (img + j * vectorBytes));
+			Vector paintedVector = _mm256_loadu_si256((const Vector*) (painted + j * vectorBytes));
+			Vector diff = _mm256_or_si256(_mm256_subs_epu8(imgVector, paintedVector),
+					_mm256_subs_epu8(paintedVector, imgVector));
+			Vector similar = _mm256_cmpeq_epi8(_mm256_min_epu8(diff, maxDiffVectors[j]), diff);
+			Vector background = _mm256_cmpeq_epi8(paintedVector, backgroundVectors[j]);
+			wellPaintedChannels[j] = _mm256_andnot_si256(background, similar);
+#else
+			Vector imgVector = _mm_loadu_si128((const Vector*) (img + j * vectorBytes));
+			Vector paintedVector = _mm_loadu_si128((const Vector*) (painted + j * vectorBytes));
+			Vector diff = _mm_or_si128(_mm_subs_epu8(imgVector, paintedVector),
+					_mm_subs_epu8(paintedVector, imgVector));
+			Vector similar = _mm_cmpeq_epi8(_mm_min_epu8(diff, maxDiffVectors[j]), diff);
+			Vector background = _mm_cmpeq_epi8(paintedVector, backgroundVectors[j]);
+			wellPaintedChannels[j] = _mm_andnot_si128(background, similar);
+#endif
+		}
+
+		// A pixel is well painted only if its three channels are well painted. The AVX2 vectors are reduced in two
+		// halves of 16 pixels.
+#if defined(OFX_OIL_SIMILARITY_AVX2)
+		__m128i firstHalf = reducePixelChannels(_mm256_castsi256_si128(wellPaintedChannels[0]),
+				_mm256_extracti128_si256(wellPaintedChannels[0], 1), _mm256_castsi256_si128(wellPaintedChannels[1]));
+		__m128i secondHalf = reducePixelChannels(_mm256_extracti128_si256(wellPaintedChannels[1], 1),
+				_mm256_castsi256_si128(wellPaintedChannels[2]), _mm256_extracti128_si256(wellPaintedChannels[2], 1));
+		Vector wellPaintedPixels = _mm256_inserti128_si256(_mm256_castsi128_si256(firstHalf), secondHalf, 1);
+		_mm256_storeu_si256((Vector*) (mask + pixel),
+				_mm256_xor_si256(wellPaintedPixels, _mm256_cmpeq_epi8(wellPaintedPixels, wellPaintedPixels)));
+#else
+		Vector wellPaintedPixels = reducePixelChannels(wellPaintedChannels[0], wellPaintedChannels[1],
+				wellPaintedChannels[2]);
+		_mm_storeu_si128((Vector*) (mask + pixel),
+				_mm_xor_si128(wellPaintedPixels, _mm_cmpeq_epi8(wellPaintedPixels, wellPaintedPixels)));
+#endif
+	}
+#endif
+
+	// Process the remaining pixels
+	for (; pixel < nPixels; ++pixel) {
+		const unsigned char* img = imgPixels + 3 * pixel;
+		const unsigned char* painted = paintedPixels + 3 * pixel;
+		bool wellPainted = painted[0] != backgroundColor.r && painted[1] != backgroundColor.g
+				&& painted[2] != backgroundColor.b && abs(img[0] - painted[0]) < maxColorDifference[0]
+				&& abs(img[1] - painted[1]) < maxColorDifference[1] && abs(img[2] - painted[2]) < maxColorDifference[2];
+		mask[pixel] = wellPainted ? 0 : 255;
+	}
+}
+
+string ofxOilSimilarityKernel::getInstructionSet() {
+#if defined(OFX_OIL_SIMILARITY_AVX2)
+	return "AVX2";
+#elif defined(OFX_OIL_SIMILARITY_SSSE3)
+	return "SSSE3";
+#elif defined(OFX_OIL_SIMILARITY_SSE2)
+	return "SSE2";
+#else
+	return "scalar";
+#endif
+}
@@ -0,0 +1,39 @@
+#pragma once
+
+#include "ofMain.h"
+
+/**
+ * @brief Class with the vectorized kernel used to compare the painted pixels with the image pixels
+ *
+ * The kernel uses AVX2, SSSE3 or SSE2 instructions when the addon is compiled with support for them (e.g. with the
+ * -mavx2 compiler flag), and falls back to scalar code otherwise.
+ *
+ * @author Javier Graciá Carpio
+ */
+class ofxOilSimilarityKernel {
+public:
+
+	/**
+	 * @brief Calculates which pixels in a row of interleaved RGB pixels are bad painted
+	 *
+	 * A pixel is well painted if all its painted color channels differ from the background color and the differences
+	 * with the image color channels are smaller than the maximum color differences.
+	 *
+	 * @param imgPixels the image pixels in interleaved RGB format
+	 * @param paintedPixels the painted pixels in interleaved RGB format
+	 * @param nPixels the number of pixels to compare
+	 * @param backgroundColor the canvas background color
+	 * @param maxColorDifference the maximum color difference allowed for each color channel
+	 * @param mask the output mask, with one value for each pixel: 255 if the pixel is bad painted, 0 otherwise
+	 */
+	static void calculateBadPaintedMask(const unsigned char* imgPixels, const unsigned char* paintedPixels,
+			unsigned int nPixels, const ofColor& backgroundColor, const array<int, 3>& maxColorDifference,
+			unsigned char* mask);
+
+	/**
+	 * @brief Returns the name of the instruction set used by the kernel
+	 *
+	 * @return the name of the instruction set used by the kernel
+	 */
+	static string getInstructionSet();
+};
@@ -1,103 +1,488 @@
 #include "ofxOilSimulator.h"
 #include "ofxOilTrace.h"
+#include "ofxOilCanvas.h"
+#include "ofxOilRandom.h"
+#include "ofxOilConfig.h"
+#include "ofxOilSimilarityKernel.h"
+#include "ofxOilMappedFile.h"
+#include "ofxOilVarianceMap.h"
+#include "ofxOilImportanceMap.h"
+#include "ofxOilWeightedSampler.h"
+#include "ofxOilBitMask.h"
 #include "ofMain.h"
 
-float ofxOilSimulator::SMALLER_BRUSH_SIZE = 4;
+const char ofxOilSimulator::STATE_MAGIC[4] = {'O', 'I', 'L', 'C'};
 
-float ofxOilSimulator::BRUSH_SIZE_DECREMENT = 1.3;
+ofxOilSimulator::ofxOilSimulator(bool _useCanvasBuffer, bool _verbose, ofxOilCanvasType _canvasType,
+		const ofxOilConfig& _config) :
+		config(make_shared<const ofxOilConfig>(_config)), useCanvasBuffer(_useCanvasBuffer), verbose(_verbose),
+		canvasType(_canvasType) {
+	canvas = ofxOilCanvas::create(canvasType, 2);
+	canvasBuffer = ofxOilCanvas::create(canvasType);
+	nBadPaintedPixels = 0;
+	fullPixelArraysUpdate = true;
+	useSeedMask = false;
+	changedFraction = 0;
+	averageBrushSize = config->smallerBrushSize;
+	paintingIsFinised = true;
+	obtainNewTrace = false;
+	searchInProgress = false;
+	nextPendingTrace = 0;
+	traceBatchStartCandidate = 0;
+	traceStep = 0;
+	nTraces = 0;
+	searchBatchSize = 1;
+	setSeed(0);
+}
 
-unsigned int ofxOilSimulator::MAX_INVALID_TRAJECTORIES = 5000;
+const ofxOilConfig& ofxOilSimulator::getConfig() const {
+	return *config;
+}
 
-unsigned int ofxOilSimulator::MAX_INVALID_TRAJECTORIES_FOR_SMALLER_SIZE = 10000;
+void ofxOilSimulator::setSeed(uint64_t seed) {
+	random = ofxOilRandom(seed);
+	nCandidates = 0;
+}
 
-unsigned int ofxOilSimulator::MAX_INVALID_TRACES = 250;
+uint64_t ofxOilSimulator::getSeed() const {
+	return random.getKey();
+}
 
-unsigned int ofxOilSimulator::MAX_INVALID_TRACES_FOR_SMALLER_SIZE = 350;
+void ofxOilSimulator::setImagePixels(const ofPixels& imagePixels, bool clearCanvas) {
+	// Set the image pixels. The image texture is only needed when painting on the GPU.
+	img.setUseTexture(canvasType == OFX_OIL_CANVAS_FBO);
+	img.setFromPixels(imagePixels);
+	img.setImageType(OF_IMAGE_COLOR);
+	varianceMap.clear();
+	stdevBoundMap.clear();
+	importanceMap.clear();
+	int imgWidth = img.getWidth();
+	int imgHeight = img.getHeight();
 
-float ofxOilSimulator::TRACE_SPEED = 2;
+	// Initialize the canvas and pixel containers if necessary
+	if (clearCanvas || imgWidth != canvas->getWidth() || imgHeight != canvas->getHeight()) {
+		// Initialize the canvas where the image will be painted
+		canvas->allocate(imgWidth, imgHeight, config->backgroundColor);
 
-float ofxOilSimulator::RELATIVE_TRACE_LENGTH = 2.3;
+		// Initialize the canvas buffer if necessary
+		if (useCanvasBuffer) {
+			canvasBuffer->allocate(imgWidth, imgHeight, config->backgroundColor);
+		}
 
-float ofxOilSimulator::MIN_TRACE_LENGTH = 16;
+		// Initialize all the pixel arrays
+		visitedMask.allocate(imgWidth, imgHeight);
+		badPaintedMask.allocate(imgWidth, imgHeight);
+		nBadPaintedPixels = 0;
+	}
 
-ofColor ofxOilSimulator::BACKGROUND_COLOR = ofColor(255);
+	// Initialize the rest of the simulator variables
+	float initialBrushSize = config->initialBrushSize > 0 ? config->initialBrushSize : max(imgWidth, imgHeight) / 6.0f;
+	averageBrushSize = max(config->smallerBrushSize, initialBrushSize);
+	fullPixelArraysUpdate = true;
+	useSeedMask = false;
+	changedFraction = 1;
+	paintingIsFinised = false;
+	obtainNewTrace = true;
+	searchInProgress = false;
+	pendingTraces.clear();
+	nextPendingTrace = 0;
+	traceBatchRegions.clear();
+	paintedRegions.clear();
+	traceStep = 0;
+	nTraces = 0;
+}
 
-array<int, 3> ofxOilSimulator::MAX_COLOR_DIFFERENCE = { 40, 40, 40 };
+void ofxOilSimulator::setImage(const ofImage& image, bool clearCanvas) {
+	setImagePixels(image.getPixels(), clearCanvas);
+}
 
-float ofxOilSimulator::MAX_VISITS_FRACTION_IN_TRAJECTORY = 0.35;
+void ofxOilSimulator::setVideoFramePixels(const ofPixels& framePixels) {
+	// Paint the frame from scratch if it's the first one or its dimensions changed
+	int imgWidth = img.getWidth();
+	int imgHeight = img.getHeight();
 
-float ofxOilSimulator::MIN_INSIDE_FRACTION_IN_TRAJECTORY = 0.4;
+	if (!img.isAllocated() || (int) framePixels.getWidth() != imgWidth
+			|| (int) framePixels.getHeight() != imgHeight) {
+		setImagePixels(framePixels, true);
+		return;
+	}
 
-float ofxOilSimulator::MAX_SIMILAR_COLOR_FRACTION_IN_TRAJECTORY = 0.6;
+	// Mark the blocks that changed since they were painted and copy them into the image
+	ofPixels rgbFramePixels = framePixels;
+	rgbFramePixels.setImageType(OF_IMAGE_COLOR);
+	unsigned int nMarkedPixels = 0;
+	unsigned int nChangedPixels = markChangedBlocks(rgbFramePixels, nMarkedPixels);
+	changedFraction = nChangedPixels / float(imgWidth * imgHeight);
 
-float ofxOilSimulator::MAX_COLOR_STDEV_IN_TRAJECTORY = 45;
+	// Keep painting the current image if nothing changed
+	if (nChangedPixels == 0) {
+		return;
+	}
 
-float ofxOilSimulator::MIN_INSIDE_FRACTION = 0.7;
+	// Update the image texture and clear the maps calculated from the image
+	img.update();
+	varianceMap.clear();
+	stdevBoundMap.clear();
+	importanceMap.clear();
+
+	// Restart the brush sizes schedule with a size that matches the marked area. The initial brush size is a sixth
+	// of the marked area side, so the full image size is used if all the blocks are marked.
+	float initialBrushSize = config->initialBrushSize > 0 ? config->initialBrushSize : max(imgWidth, imgHeight) / 6.0f;
+	averageBrushSize = max(config->smallerBrushSize, min(initialBrushSize, sqrt(float(nMarkedPixels)) / 6.0f));
+	fullPixelArraysUpdate = true;
+	useSeedMask = true;
+	paintingIsFinised = false;
+	obtainNewTrace = true;
+	searchInProgress = false;
+	pendingTraces.clear();
+	nextPendingTrace = 0;
+	traceBatchRegions.clear();
+	paintedRegions.clear();
+	traceStep = 0;
+	nTraces = 0;
+}
 
-float ofxOilSimulator::MAX_SIMILAR_COLOR_FRACTION = 0.8; // 0.8 - 0.85 - 0.5
+void ofxOilSimulator::setVideoFrame(const ofImage& frame) {
+	setVideoFramePixels(frame.getPixels());
+}
 
-float ofxOilSimulator::MAX_PAINTED_FRACTION = 0.65;
+unsigned int ofxOilSimulator::markChangedBlocks(const ofPixels& framePixels, unsigned int& nMarkedPixels) {
+	// Extract some useful information
+	unsigned char* imgData = img.getPixels().getData();
+	const unsigned char* frameData = framePixels.getData();
+	int width = img.getWidth();
+	int height = img.getHeight();
+	int blockSize = max(config->videoBlockSize, 1u);
+	int nBlocksX = ceil(width / float(blockSize));
+	int nBlocksY = ceil(height / float(blockSize));
 
-float ofxOilSimulator::MIN_COLOR_IMPROVEMENT_FACTOR = 0.6;
+	if (!seedMaskPixels.isAllocated() || (int) seedMaskPixels.getWidth() != width
+			|| (int) seedMaskPixels.getHeight() != height) {
+		seedMaskPixels.allocate(width, height, OF_PIXELS_GRAY);
+	}
 
-float ofxOilSimulator::BIG_WELL_PAINTED_IMPROVEMENT_FRACTION = 0.3; // 0.3 - 0.35 - 0.4
+	// Unmark all the blocks if the marked blocks have been painted or the whole image was painted from scratch
+	if (!useSeedMask || paintingIsFinised) {
+		seedMaskPixels.setColor(0);
+	}
 
-float ofxOilSimulator::MIN_BAD_PAINTED_REDUCTION_FRACTION = 0.45; // 0.45 - 0.3 - 0.45
+	unsigned char* seedMaskData = seedMaskPixels.getData();
 
-float ofxOilSimulator::MAX_WELL_PAINTED_DESTRUCTION_FRACTION = 0.4; // 0.4 - 0.55 - 0.4
+	// Compare the blocks in each row of blocks and count the pixels inside the changed and the marked blocks
+	vector<unsigned int> rowsChangedPixels(nBlocksY, 0);
+	vector<unsigned int> rowsMarkedPixels(nBlocksY, 0);
+	auto compareBlocksRow = [&](unsigned int blockY) {
+		int yMin = blockY * blockSize;
+		int yMax = min(yMin + blockSize, height);
 
-ofxOilSimulator::ofxOilSimulator(bool _useCanvasBuffer, bool _verbose) :
-		useCanvasBuffer(_useCanvasBuffer), verbose(_verbose) {
-	nBadPaintedPixels = 0;
-	averageBrushSize = SMALLER_BRUSH_SIZE;
-	paintingIsFinised = true;
-	obtainNewTrace = false;
-	traceStep = 0;
-	nTraces = 0;
+		for (int blockX = 0; blockX < nBlocksX; ++blockX) {
+			int xMin = blockX * blockSize;
+			int xMax = min(xMin + blockSize, width);
+
+			// Calculate the average color channel difference inside the block
+			unsigned int differenceSum = 0;
+
+			for (int y = yMin; y < yMax; ++y) {
+				for (int index = 3 * (xMin + y * width), end = 3 * (xMax + y * width); index < end; ++index) {
+					differenceSum += abs(imgData[index] - frameData[index]);
+				}
+			}
+
+			unsigned int nBlockPixels = (xMax - xMin) * (yMax - yMin);
+			bool changed = differenceSum > config->videoChangeThreshold * 3 * nBlockPixels;
+
+			if (changed) {
+				// Copy the block into the image and mark it in the seed mask, keeping the marks of previous frames
+				for (int y = yMin; y < yMax; ++y) {
+					size_t index = 3 * (xMin + size_t(y) * width);
+					memcpy(imgData + index, frameData + index, 3 * (xMax - xMin));
+					memset(seedMaskData + xMin + y * width, 255, xMax - xMin);
+				}
+
+				rowsChangedPixels[blockY] += nBlockPixels;
+			}
+
+			if (seedMaskData[xMin + yMin * width] != 0) {
+				rowsMarkedPixels[blockY] += nBlockPixels;
+			}
+		}
+	};
+
+	if (threadPool && nBlocksY > 1) {
+		threadPool->parallelFor(nBlocksY, compareBlocksRow);
+	} else {
+		for (int blockY = 0; blockY < nBlocksY; ++blockY) {
+			compareBlocksRow(blockY);
+		}
+	}
+
+	unsigned int nChangedPixels = 0;
+	nMarkedPixels = 0;
+
+	for (int blockY = 0; blockY < nBlocksY; ++blockY) {
+		nChangedPixels += rowsChangedPixels[blockY];
+		nMarkedPixels += rowsMarkedPixels[blockY];
+	}
+
+	return nChangedPixels;
 }
 
-void ofxOilSimulator::setImagePixels(const ofPixels& imagePixels, bool clearCanvas) {
-	// Set the image pixels
-	img = ofImage(imagePixels);
-	int imgWidth = img.getWidth();
-	int imgHeight = img.getHeight();
+void ofxOilSimulator::setCanvasPixels(const ofPixels& canvasPixels, const ofPixels& canvasBufferPixels) {
+	// Check that the input makes sense
+	if (canvasPixels.getWidth() != img.getWidth() || canvasPixels.getHeight() != img.getHeight()) {
+		throw invalid_argument("The canvas pixels should have the same dimensions as the image.");
+	} else if (useCanvasBuffer
+			&& (canvasBufferPixels.getWidth() != img.getWidth() || canvasBufferPixels.getHeight() != img.getHeight())) {
+		throw invalid_argument("The canvas buffer pixels should have the same dimensions as the image.");
+	}
 
-	// Initialize the canvas and pixel containers if necessary
-	if (clearCanvas || imgWidth != canvas.getWidth() || imgHeight != canvas.getHeight()) {
-		// Initialize the canvas where the image will be painted
-		canvas.allocate(imgWidth, imgHeight, GL_RGB, 2);
-		canvas.begin();
-		ofClear(BACKGROUND_COLOR);
-		canvas.end();
+	canvas->setPixels(canvasPixels);
 
-		// Initialize the canvas buffer if necessary
-		if (useCanvasBuffer) {
-			canvasBuffer.allocate(imgWidth, imgHeight, GL_RGB);
-			canvasBuffer.begin();
-			ofClear(BACKGROUND_COLOR);
-			canvasBuffer.end();
+	if (useCanvasBuffer) {
+		canvasBuffer->setPixels(canvasBufferPixels);
+	}
+
+	// All the pixels should be checked again
+	fullPixelArraysUpdate = true;
+}
+
+const ofPixels& ofxOilSimulator::getCanvasPixels() {
+	canvas->updatePixels();
+	return canvas->getPixels();
+}
+
+const ofPixels& ofxOilSimulator::getCanvasBufferPixels() {
+	if (!useCanvasBuffer) {
+		return getCanvasPixels();
+	}
+
+	canvasBuffer->updatePixels();
+	return canvasBuffer->getPixels();
+}
+
+void ofxOilSimulator::setSeedRegion(const ofRectangle& region) {
+	seedRegion = region;
+	fullPixelArraysUpdate = true;
+	searchInProgress = false;
+}
+
+void ofxOilSimulator::setNThreads(unsigned int nThreads) {
+	// Create the thread pool only if it's going to be used
+	if (nThreads != 1) {
+		threadPool.reset(new ofxOilThreadPool(nThreads));
+	} else {
+		threadPool.reset();
+	}
+}
+
+void ofxOilSimulator::setSpeculativeSearch(unsigned int batchSize, unsigned int nThreads) {
+	searchBatchSize = max(1u, batchSize);
+
+	if (searchBatchSize > 1) {
+		setNThreads(nThreads);
+	}
+}
+
+void ofxOilSimulator::startStrokeLog(const string& path) {
+	// Check that the image has been set
+	if (!img.isAllocated()) {
+		throw logic_error("Please, set the image before starting the stroke log.");
+	}
+
+	strokeLog.reset(new ofxOilStrokeLogWriter(path, img.getWidth(), img.getHeight(), config->backgroundColor));
+}
+
+void ofxOilSimulator::stopStrokeLog() {
+	strokeLog.reset();
+}
+
+void ofxOilSimulator::saveState(const string& path) {
+	// Check that the image has been set
+	if (!img.isAllocated()) {
+		throw logic_error("Please, set the image before saving the simulator state.");
+	}
+
+	// Finish painting the current trace and the pending traces, without searching new ones, and add them to the
+	// visited pixels, so they don't need to be saved
+	while (!obtainNewTrace) {
+		while (traceStep < trace.getNSteps()) {
+			paintTraceStep();
 		}
 
-		// Initialize all the pixel arrays
-		visitedPixels.allocate(imgWidth, imgHeight, OF_PIXELS_GRAY);
-		similarColorPixels.allocate(imgWidth, imgHeight, OF_PIXELS_GRAY);
-		badPaintedPixels = vector<unsigned int>(imgWidth * imgHeight);
-		nBadPaintedPixels = 0;
+		startNextTrace();
 	}
 
-	// Initialize the rest of the simulator variables
-	averageBrushSize = max(SMALLER_BRUSH_SIZE, max(imgWidth, imgHeight) / 6.0f);
-	paintingIsFinised = false;
+	if (nTraces > 0) {
+		updateVisitedPixels();
+	}
+
+	// Write the header
+	string temporaryPath = path + ".tmp";
+	ofstream file(ofToDataPath(temporaryPath, true), ios::binary | ios::trunc);
+
+	if (!file) {
+		throw runtime_error("The simulator state file " + path + " could not be created.");
+	}
+
+	auto write = [&file](const auto& value) {
+		file.write(reinterpret_cast<const char*>(&value), sizeof(value));
+	};
+
+	file.write(STATE_MAGIC, 4);
+	write(uint32_t(STATE_VERSION));
+	write(uint32_t(img.getWidth()));
+	write(uint32_t(img.getHeight()));
+	write(uint8_t(useCanvasBuffer));
+	write(uint8_t(paintingIsFinised));
+	write(averageBrushSize);
+	write(random.getKey());
+	write(nCandidates);
+	write(uint32_t(nTraces));
+
+	// Write the pixel arrays
+	const ofPixels& canvasPixels = getCanvasPixels();
+	file.write(reinterpret_cast<const char*>(canvasPixels.getData()), canvasPixels.getTotalBytes());
+
+	if (useCanvasBuffer) {
+		const ofPixels& canvasBufferPixels = getCanvasBufferPixels();
+		file.write(reinterpret_cast<const char*>(canvasBufferPixels.getData()), canvasBufferPixels.getTotalBytes());
+	}
+
+	// Write the visited pixels with one byte per pixel: 0 if visited, 255 otherwise
+	vector<unsigned char> row(img.getWidth());
+
+	for (int y = 0, height = img.getHeight(); y < height; ++y) {
+		visitedMask.getRow(0, y, row.size(), row.data(), 0, 255);
+		file.write(reinterpret_cast<const char*>(row.data()), row.size());
+	}
+
+	file.close();
+
+	// Replace the previous checkpoint
+	if (!file || !ofFile::moveFromTo(temporaryPath, path, true, true)) {
+		throw runtime_error("The simulator state could not be written to " + path + ".");
+	}
+}
+
+void ofxOilSimulator::loadState(const string& path) {
+	// Check that the image has been set
+	if (!img.isAllocated()) {
+		throw logic_error("Please, set the image before loading the simulator state.");
+	}
+
+	// Map the file and check its header
+	ofxOilMappedFile file;
+	file.open(path);
+	const unsigned char* position = file.getData();
+	const unsigned char* end = position + file.getSize();
+
+	auto read = [&position, end, &path](auto& value) {
+		if (size_t(end - position) < sizeof(value)) {
+			throw runtime_error("The simulator state file " + path + " is truncated.");
+		}
+
+		memcpy(&value, position, sizeof(value));
+		position += sizeof(value);
+	};
+
+	char magic[4] = {};
+	uint32_t version = 0;
+	uint32_t width = 0;
+	uint32_t height = 0;
+	uint8_t usesCanvasBuffer = 0;
+	uint8_t isFinished = 0;
+	float brushSize = 0;
+	uint64_t seed = 0;
+	uint64_t candidatesCounter = 0;
+	uint32_t tracesCounter = 0;
+
+	read(magic);
+
+	if (!equal(magic, magic + 4, STATE_MAGIC)) {
+		throw runtime_error("The file " + path + " is not a simulator state file.");
+	}
+
+	read(version);
+	read(width);
+	read(height);
+	read(usesCanvasBuffer);
+	read(isFinished);
+	read(brushSize);
+	read(seed);
+	read(candidatesCounter);
+	read(tracesCounter);
+
+	if (version != STATE_VERSION) {
+		throw runtime_error("The simulator state file " + path + " has an unsupported version.");
+	} else if (width != img.getWidth() || height != img.getHeight()) {
+		throw runtime_error("The simulator state dimensions don't coincide with the image dimensions.");
+	} else if (bool(usesCanvasBuffer) != useCanvasBuffer) {
+		throw runtime_error("The simulator state was saved with a different canvas buffer setting.");
+	}
+
+	size_t nPixels = size_t(width) * height;
+	size_t expectedSize = (useCanvasBuffer ? 7 : 4) * nPixels;
+
+	if (size_t(end - position) != expectedSize) {
+		throw runtime_error("The simulator state file " + path + " has an unexpected size.");
+	}
+
+	// Copy the pixel arrays from the mapped file
+	ofPixels canvasPixels;
+	canvasPixels.setFromPixels(position, width, height, OF_PIXELS_RGB);
+	canvas->setPixels(canvasPixels);
+	position += 3 * nPixels;
+
+	if (useCanvasBuffer) {
+		canvasPixels.setFromPixels(position, width, height, OF_PIXELS_RGB);
+		canvasBuffer->setPixels(canvasPixels);
+		position += 3 * nPixels;
+	}
+
+	// The visited pixels are stored with one byte per pixel: 0 if visited, 255 otherwise
+	vector<unsigned char> row(width);
+
+	for (uint32_t y = 0; y < height; ++y) {
+		for (uint32_t x = 0; x < width; ++x) {
+			row[x] = position[x] == 0;
+		}
+
+		visitedMask.setRow(0, y, width, row.data());
+		position += width;
+	}
+
+	// Restore the rest of the simulator variables. The last trace is already included in the visited pixels.
+	averageBrushSize = brushSize;
+	random = ofxOilRandom(seed);
+	nCandidates = candidatesCounter;
+	nTraces = tracesCounter;
+	paintingIsFinised = isFinished != 0;
+	trace = ofxOilTrace();
 	obtainNewTrace = true;
+	searchInProgress = false;
+	pendingTraces.clear();
+	nextPendingTrace = 0;
+	traceBatchRegions.clear();
+	paintedRegions.clear();
 	traceStep = 0;
-	nTraces = 0;
+	fullPixelArraysUpdate = true;
 }
 
-void ofxOilSimulator::setImage(const ofImage& image, bool clearCanvas) {
-	setImagePixels(image.getPixels(), clearCanvas);
+void ofxOilSimulator::update(bool stepByStep) {
+	updateUntil(stepByStep, chrono::steady_clock::time_point::max());
 }
 
-void ofxOilSimulator::update(bool stepByStep) {
+void ofxOilSimulator::updateWithBudget(unsigned int microseconds) {
+	// Paint trace steps until the time budget is consumed, the painting is finished or the new trace search is
+	// interrupted
+	chrono::steady_clock::time_point deadline = chrono::steady_clock::now() + chrono::microseconds(microseconds);
+
+	do {
+		updateUntil(true, deadline);
+	} while (!paintingIsFinised && !(obtainNewTrace && searchInProgress) && chrono::steady_clock::now() < deadline);
+}
+
+void ofxOilSimulator::updateUntil(bool stepByStep, const chrono::steady_clock::time_point& deadline) {
 	// Don't do anything if the painting is finished
 	if (paintingIsFinised) {
 		return;
@@ -105,88 +490,303 @@ void ofxOilSimulator::update(bool stepByStep) {
 
 	// Check if a new trace should be obtained
 	if (obtainNewTrace) {
-		// Update the pixel arrays
-		updatePixelArrays();
+		// Update the pixel arrays, unless we are continuing an interrupted search or they are already updated
+		chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+		if (!searchInProgress && (nTraces == 0 || fullPixelArraysUpdate || !paintedRegions.empty())) {
+			updatePixelArrays();
+			start = stats.updatePixelArrays.addCall(start);
+		}
 
 		// Get a new trace
-		getNewTrace();
+		getNewTrace(deadline, numeric_limits<uint64_t>::max(), false);
+		stats.search.addCall(start);
 	}
 
-	// Paint the current trace if the painting is not finished
-	if (!paintingIsFinised) {
+	// Paint the current trace if we have one
+	if (!paintingIsFinised && !obtainNewTrace) {
+		chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
 		if (stepByStep) {
 			// Paint the current trace step
 			paintTraceStep();
+			stats.painting.addCall(start);
 
 			// Check if we finished painting the trace
 			if (traceStep == trace.getNSteps()) {
-				obtainNewTrace = true;
+				startNextTrace();
+			}
+
+			// Search the next trace while the current trace is painted, if it was not found already
+			if (config->pipelinedSearchCandidates > 0 && !obtainNewTrace
+					&& nextPendingTrace == pendingTraces.size()) {
+				chrono::steady_clock::time_point searchStart = chrono::steady_clock::now();
+				getNewTrace(chrono::steady_clock::time_point::max(), nCandidates + config->pipelinedSearchCandidates,
+						true);
+				stats.search.addCall(searchStart);
 			}
 		} else {
 			// Paint all the trace steps
 			paintTrace();
-			obtainNewTrace = true;
+			stats.painting.addCall(start);
+			startNextTrace();
 		}
 	}
 }
 
+const ofPixels& ofxOilSimulator::getPaintedPixels() const {
+	return useCanvasBuffer ? canvasBuffer->getPixels() : canvas->getPixels();
+}
+
 void ofxOilSimulator::updatePixelArrays() {
 	// Update the visited pixels array
 	updateVisitedPixels();
 
 	// Update the painted pixels array
 	if (useCanvasBuffer) {
-		canvasBuffer.readToPixels(paintedPixels);
+		canvasBuffer->updatePixels();
 	} else {
-		canvas.readToPixels(paintedPixels);
+		canvas->updatePixels();
 	}
 
-	// Update the similar color pixels and the bad painted pixels arrays
-	const ofPixels& imgPixels = img.getPixels();
-	unsigned int imgNumChannels = imgPixels.getNumChannels();
-	unsigned int canvasNumChannels = paintedPixels.getNumChannels();
-	nBadPaintedPixels = 0;
+	// Update the similar color pixels and the bad painted pixels arrays in a given region
+	int width = img.getWidth();
+	int height = img.getHeight();
+	auto updateRegion = [this, width, height](int xMin, int yMin, int xMax, int yMax, bool fullUpdate) {
+		// The pixels outside the seed region are never added to the bad painted pixels
+		xMin = max(xMin, 0);
+		yMin = max(yMin, 0);
+		xMax = min(xMax, width);
+		yMax = min(yMax, height);
+
+		if (!seedRegion.isEmpty()) {
+			xMin = max(xMin, (int) ceil(seedRegion.getMinX()));
+			yMin = max(yMin, (int) ceil(seedRegion.getMinY()));
+			xMax = min(xMax, (int) ceil(seedRegion.getMaxX()));
+			yMax = min(yMax, (int) ceil(seedRegion.getMaxY()));
+		}
 
-	for (unsigned int pixel = 0, nPixels = img.getWidth() * img.getHeight(); pixel < nPixels; ++pixel) {
-		unsigned int imgPix = pixel * imgNumChannels;
-		unsigned int canvasPix = pixel * canvasNumChannels;
-
-		// Check if the pixel is well painted
-		if (paintedPixels[canvasPix] != BACKGROUND_COLOR.r && paintedPixels[canvasPix + 1] != BACKGROUND_COLOR.g
-				&& paintedPixels[canvasPix + 2] != BACKGROUND_COLOR.b
-				&& abs(imgPixels[imgPix] - paintedPixels[canvasPix]) < MAX_COLOR_DIFFERENCE[0]
-				&& abs(imgPixels[imgPix + 1] - paintedPixels[canvasPix + 1]) < MAX_COLOR_DIFFERENCE[1]
-				&& abs(imgPixels[imgPix + 2] - paintedPixels[canvasPix + 2]) < MAX_COLOR_DIFFERENCE[2]) {
-			similarColorPixels[pixel] = 0;
-		} else {
-			similarColorPixels[pixel] = 255;
-			badPaintedPixels[nBadPaintedPixels] = pixel;
-			++nBadPaintedPixels;
+		if (xMin < xMax && yMin < yMax) {
+			if (fullUpdate) {
+				scanSimilarColorPixels(xMin, yMin, xMax, yMax);
+			} else {
+				updateSimilarColorPixels(xMin, yMin, xMax, yMax);
+			}
+		}
+	};
+
+	if (nTraces == 0 || fullPixelArraysUpdate) {
+		// Mark all the pixels as well painted and check them all at the beginning of a simulation
+		badPaintedMask.setAll(false);
+		badPaintedTiles.reset(((width + BAD_PAINTED_TILE_SIZE - 1) / BAD_PAINTED_TILE_SIZE)
+				* ((height + BAD_PAINTED_TILE_SIZE - 1) / BAD_PAINTED_TILE_SIZE));
+		nBadPaintedPixels = 0;
+		fullPixelArraysUpdate = false;
+		updateRegion(0, 0, width, height, true);
+	} else {
+		// Check only the pixels in the regions covered by the last painted traces
+		for (const ofRectangle& region : paintedRegions) {
+			updateRegion(floor(region.getMinX()), floor(region.getMinY()), ceil(region.getMaxX()) + 1,
+					ceil(region.getMaxY()) + 1, false);
 		}
 	}
+
+	paintedRegions.clear();
+}
+
+void ofxOilSimulator::scanSimilarColorPixels(int xMin, int yMin, int xMax, int yMax) {
+	// Extract some useful information
+	const unsigned char* imgData = img.getPixels().getData();
+	const unsigned char* paintedData = getPaintedPixels().getData();
+	unsigned int width = img.getWidth();
+	unsigned int height = img.getHeight();
+	unsigned int regionWidth = xMax - xMin;
+	unsigned int regionHeight = yMax - yMin;
+
+	// All the pixels start with a zero error weight
+	bool useErrorWeights = config->errorWeightedSampling;
+
+	if (useErrorWeights) {
+		errorSampler.reset(width * height);
+	}
+
+	// Divide the region in chunks of rows that can be processed in parallel
+	unsigned int nChunks = threadPool ? max(1u, min(4 * threadPool->getNThreads(), regionHeight)) : 1;
+	auto chunkStartRow = [yMin, regionHeight, nChunks](unsigned int chunk) {
+		return yMin + (chunk * regionHeight) / nChunks;
+	};
+
+	// Calculate the bad painted mask rows in each chunk
+	auto calculateMask = [&](unsigned int chunk) {
+		vector<unsigned char> mask(regionWidth);
+
+		for (int y = chunkStartRow(chunk), yEnd = chunkStartRow(chunk + 1); y < yEnd; ++y) {
+			unsigned int pixel = xMin + y * width;
+			ofxOilSimilarityKernel::calculateBadPaintedMask(imgData + 3 * pixel, paintedData + 3 * pixel,
+					regionWidth, config->backgroundColor, config->maxColorDifference, mask.data());
+
+			// The pixels outside the seed mask are never added to the bad painted pixels
+			if (useSeedMask) {
+				const unsigned char* seedMask = seedMaskPixels.getData() + pixel;
+
+				for (unsigned int i = 0; i < regionWidth; ++i) {
+					mask[i] &= seedMask[i];
+				}
+			}
+
+			badPaintedMask.setRow(xMin, y, regionWidth, mask.data());
+
+			// Set the error weights of the bad painted pixels
+			if (useErrorWeights) {
+				for (unsigned int i = 0; i < regionWidth; ++i) {
+					if (mask[i] != 0) {
+						errorSampler.setInitialWeight(pixel + i,
+								getErrorWeight(imgData + 3 * (pixel + i), paintedData + 3 * (pixel + i)));
+					}
+				}
+			}
+		}
+	};
+
+	// Count the bad painted pixels in the tiles that overlap the region, one row of tiles at a time. The other tiles
+	// have been reset to zero.
+	unsigned int nTilesX = (width + BAD_PAINTED_TILE_SIZE - 1) / BAD_PAINTED_TILE_SIZE;
+	unsigned int firstTileRow = yMin / BAD_PAINTED_TILE_SIZE;
+	unsigned int nTileRows = (yMax + BAD_PAINTED_TILE_SIZE - 1) / BAD_PAINTED_TILE_SIZE - firstTileRow;
+	auto countTiles = [&](unsigned int tileRow) {
+		int tileYMin = (firstTileRow + tileRow) * BAD_PAINTED_TILE_SIZE;
+		int tileYMax = min<int>(tileYMin + BAD_PAINTED_TILE_SIZE, height);
+
+		for (unsigned int tileX = xMin / BAD_PAINTED_TILE_SIZE; tileX * BAD_PAINTED_TILE_SIZE < (unsigned int) xMax;
+				++tileX) {
+			int tileXMin = tileX * BAD_PAINTED_TILE_SIZE;
+			int tileXMax = min<int>(tileXMin + BAD_PAINTED_TILE_SIZE, width);
+			badPaintedTiles.setInitialWeight((firstTileRow + tileRow) * nTilesX + tileX,
+					badPaintedMask.count(tileXMin, tileYMin, tileXMax, tileYMax));
+		}
+	};
+
+	if (threadPool && nChunks > 1) {
+		threadPool->parallelFor(nChunks, calculateMask);
+		threadPool->parallelFor(nTileRows, countTiles);
+	} else {
+		calculateMask(0);
+
+		for (unsigned int tileRow = 0; tileRow < nTileRows; ++tileRow) {
+			countTiles(tileRow);
+		}
+	}
+
+	badPaintedTiles.build();
+	nBadPaintedPixels = badPaintedTiles.getTotalWeight();
+
+	if (useErrorWeights) {
+		errorSampler.build();
+	}
+}
+
+void ofxOilSimulator::updateSimilarColorPixels(int xMin, int yMin, int xMax, int yMax) {
+	// Extract some useful information
+	const unsigned char* imgData = img.getPixels().getData();
+	const unsigned char* paintedData = getPaintedPixels().getData();
+	unsigned int width = img.getWidth();
+	unsigned int regionWidth = xMax - xMin;
+	rowMask.resize(regionWidth);
+
+	for (int y = yMin; y < yMax; ++y) {
+		// Check which pixels in the row are bad painted
+		unsigned int firstPixel = xMin + y * width;
+		ofxOilSimilarityKernel::calculateBadPaintedMask(imgData + 3 * firstPixel, paintedData + 3 * firstPixel,
+				regionWidth, config->backgroundColor, config->maxColorDifference, rowMask.data());
+
+		// The pixels outside the seed mask are never added to the bad painted pixels
+		if (useSeedMask) {
+			const unsigned char* seedMask = seedMaskPixels.getData() + firstPixel;
+
+			for (unsigned int i = 0; i < regionWidth; ++i) {
+				rowMask[i] &= seedMask[i];
+			}
+		}
+
+		badPaintedMask.setRow(xMin, y, regionWidth, rowMask.data());
+
+		// Update the pixel error weights, since the error can change even if the pixel is still bad painted
+		if (config->errorWeightedSampling) {
+			for (unsigned int i = 0; i < regionWidth; ++i) {
+				unsigned int pixel = firstPixel + i;
+				errorSampler.setWeight(pixel,
+						rowMask[i] != 0 ? getErrorWeight(imgData + 3 * pixel, paintedData + 3 * pixel) : 0);
+			}
+		}
+	}
+
+	updateBadPaintedTiles(xMin, yMin, xMax, yMax);
+}
+
+unsigned short ofxOilSimulator::getErrorWeight(const unsigned char* imgColor, const unsigned char* paintedColor) {
+	return 1 + abs(imgColor[0] - paintedColor[0]) + abs(imgColor[1] - paintedColor[1])
+			+ abs(imgColor[2] - paintedColor[2]);
+}
+
+void ofxOilSimulator::updateBadPaintedTiles(int xMin, int yMin, int xMax, int yMax) {
+	// Count the bad painted pixels in each tile and update the tile weights with the difference
+	int width = img.getWidth();
+	int height = img.getHeight();
+	unsigned int nTilesX = (width + BAD_PAINTED_TILE_SIZE - 1) / BAD_PAINTED_TILE_SIZE;
+
+	for (int tileY = yMin / BAD_PAINTED_TILE_SIZE; tileY * BAD_PAINTED_TILE_SIZE < yMax; ++tileY) {
+		for (int tileX = xMin / BAD_PAINTED_TILE_SIZE; tileX * BAD_PAINTED_TILE_SIZE < xMax; ++tileX) {
+			int tileXMin = tileX * BAD_PAINTED_TILE_SIZE;
+			int tileYMin = tileY * BAD_PAINTED_TILE_SIZE;
+			unsigned int tile = tileY * nTilesX + tileX;
+			unsigned short counter = badPaintedMask.count(tileXMin, tileYMin,
+					min(tileXMin + BAD_PAINTED_TILE_SIZE, width), min(tileYMin + BAD_PAINTED_TILE_SIZE, height));
+			nBadPaintedPixels = nBadPaintedPixels + counter - badPaintedTiles.getWeight(tile);
+			badPaintedTiles.setWeight(tile, counter);
+		}
+	}
+}
+
+unsigned int ofxOilSimulator::getBadPaintedPixel(unsigned int index) const {
+	// Find the tile that contains the pixel and the pixel position inside the tile
+	uint64_t offset = 0;
+	unsigned int tile = badPaintedTiles.find(index, offset);
+	int width = img.getWidth();
+	int height = img.getHeight();
+	int nTilesX = (width + BAD_PAINTED_TILE_SIZE - 1) / BAD_PAINTED_TILE_SIZE;
+	int tileXMin = (tile % nTilesX) * BAD_PAINTED_TILE_SIZE;
+	int tileYMin = (tile / nTilesX) * BAD_PAINTED_TILE_SIZE;
+	int x = 0;
+	int y = 0;
+	badPaintedMask.findSetBit(tileXMin, tileYMin, min(tileXMin + BAD_PAINTED_TILE_SIZE, width),
+			min(tileYMin + BAD_PAINTED_TILE_SIZE, height), offset, x, y);
+	return x + y * width;
 }
 
 void ofxOilSimulator::updateVisitedPixels() {
 	// Check if we are at the beginning of a simulation
 	if (nTraces == 0) {
-		// Reset the visited pixels array
-		visitedPixels.setColor(255);
+		// Reset the visited pixels mask
+		visitedMask.setAll(false);
 	} else {
 		// Update the visited pixels arrays with the trace bristle positions
 		const vector<unsigned char>& alphas = trace.getTrajectoryAphas();
-		const vector<vector<glm::vec2>>& bristlePositions = trace.getBristlePositions();
-		int width = visitedPixels.getWidth();
-		int height = visitedPixels.getHeight();
+		const vector<unsigned char>& bristleSteps = trace.getBristleSteps();
+		const vector<glm::vec2>& bristlePositions = trace.getBristlePositions();
+		unsigned int nBristles = trace.getNBristles();
+		int width = visitedMask.getWidth();
+		int height = visitedMask.getHeight();
 
-		for (unsigned int i = 0, nSteps = trace.getNSteps(); i < nSteps; ++i) {
+		for (unsigned int i = 0, nSteps = bristleSteps.size(); i < nSteps; ++i) {
 			// Fill the visited pixels array if alpha is high enough
-			if (alphas[i] >= ofxOilTrace::MIN_ALPHA) {
-				for (const glm::vec2& pos : bristlePositions[i]) {
+			if (alphas[i] >= config->minAlpha && bristleSteps[i] != 0) {
+				for (unsigned int index = i * nBristles, end = index + nBristles; index < end; ++index) {
+					const glm::vec2& pos = bristlePositions[index];
 					int x = pos.x;
 					int y = pos.y;
 
 					if (x >= 0 && x < width && y >= 0 && y < height) {
-						visitedPixels.setColor(x, y, 0);
+						visitedMask.set(x, y, true);
 					}
 				}
 			}
@@ -194,34 +794,83 @@ void ofxOilSimulator::updateVisitedPixels() {
 	}
 }
 
-void ofxOilSimulator::getNewTrace() {
-	// Loop until a new trace is found or the painting is finished
-	unsigned int invalidTrajectoriesCounter = 0;
-	unsigned int invalidTracesCounter = 0;
-	int imgWidth = img.getWidth();
+void ofxOilSimulator::getNewTrace(const chrono::steady_clock::time_point& deadline, uint64_t candidatesLimit,
+		bool prefetch) {
+	// Reset the search counters if this is a new search
+	if (!searchInProgress) {
+		invalidTrajectoriesCounter = 0;
+		invalidTracesCounter = 0;
+		nBatchCandidates = 0;
+		nextCandidate = 0;
+		searchInProgress = true;
+	}
+
+	// Interrupts the search if the deadline or the candidates limit were reached, painting the traces already accepted
+	// in the batch. The search continues from the same point in the next call.
+	auto interruptSearch = [this, &deadline, candidatesLimit, prefetch]() {
+		if (nCandidates < candidatesLimit && chrono::steady_clock::now() < deadline) {
+			return false;
+		}
+
+		if (!prefetch && !traceBatchRegions.empty()) {
+			finishTraceBatch();
+		}
+
+		return true;
+	};
 
+	// Loop until a new trace batch is found, the painting is finished or the deadline is reached
 	while (true) {
 		// Check if we should stop the painting simulation
-		if (averageBrushSize == SMALLER_BRUSH_SIZE
-				&& (invalidTrajectoriesCounter > MAX_INVALID_TRAJECTORIES_FOR_SMALLER_SIZE
-						|| invalidTracesCounter > MAX_INVALID_TRACES_FOR_SMALLER_SIZE)) {
+		if (nBadPaintedPixels == 0 || (averageBrushSize == config->smallerBrushSize
+				&& (invalidTrajectoriesCounter > config->maxInvalidTrajectoriesForSmallerSize
+						|| invalidTracesCounter > config->maxInvalidTracesForSmallerSize))) {
+			// Leave the decision to the search that starts after the current trace is painted
+			if (prefetch) {
+				return;
+			}
+
+			// Paint the traces already accepted in the batch before stopping
+			if (!traceBatchRegions.empty()) {
+				finishTraceBatch();
+				break;
+			}
+
 			// Print some debug information if necessary
 			if (verbose) {
 				ofLogNotice() << "Total number of painted traces: " << nTraces;
 				ofLogNotice() << "Processing time = " << ofGetElapsedTimef() << " seconds";
+				ofLogNotice() << "Candidates = " << stats.getNCandidates() << ", rejected as visited = "
+						<< stats.visitedRejections << ", outside canvas = " << stats.outsideCanvasRejections
+						<< ", well painted = " << stats.wellPaintedRejections << ", high color stdev = "
+						<< stats.highColorStdevRejections << ", batch overlap = " << stats.batchOverlapRejections
+						<< ", no improvement = " << stats.noImprovementRejections << ", redrawn seeds = "
+						<< stats.seedPrefilterRedraws;
 			}
 
 			// Stop the painting
 			paintingIsFinised = true;
+			searchInProgress = false;
 			break;
 		} else {
 			// Change the average brush size if there were too many invalid traces
-			if (averageBrushSize > SMALLER_BRUSH_SIZE
-					&& (invalidTrajectoriesCounter > MAX_INVALID_TRAJECTORIES
-							|| invalidTracesCounter > MAX_INVALID_TRACES)) {
+			if (averageBrushSize > config->smallerBrushSize
+					&& (invalidTrajectoriesCounter > config->maxInvalidTrajectories
+							|| invalidTracesCounter > config->maxInvalidTraces)) {
+				// Leave the brush size change to the search that starts after the current trace is painted
+				if (prefetch) {
+					return;
+				}
+
+				// Paint the traces already accepted in the batch before changing the brush size
+				if (!traceBatchRegions.empty()) {
+					finishTraceBatch();
+					break;
+				}
+
 				// Decrease the brush size
-				averageBrushSize = max(SMALLER_BRUSH_SIZE,
-						min(averageBrushSize / BRUSH_SIZE_DECREMENT, averageBrushSize - 2));
+				averageBrushSize = max(config->smallerBrushSize,
+						min(averageBrushSize / config->brushSizeDecrement, averageBrushSize - 2));
 
 				// Print some debug information if necessary
 				if (verbose) {
@@ -233,26 +882,40 @@ void ofxOilSimulator::getNewTrace() {
 				invalidTrajectoriesCounter = 0;
 				invalidTracesCounter = 0;
 
-				// Reset the visited pixels array
-				visitedPixels.setColor(255);
+				// Reset the visited pixels mask
+				visitedMask.setAll(false);
+
+				// Discard the remaining candidates, since they were created with the previous brush size
+				nextCandidate = nBatchCandidates;
 			}
 
-			// Create new traces until one of them has a valid trajectory or we exceed a number of tries
+			// Process the candidate traces until one of them has a valid trajectory or we exceed a number of tries
 			bool isValidTrajectory = false;
-			float brushSize = max(SMALLER_BRUSH_SIZE, averageBrushSize * ofRandom(0.95, 1.05));
-			int nSteps = max(MIN_TRACE_LENGTH, RELATIVE_TRACE_LENGTH * brushSize * ofRandom(0.9, 1.1)) / TRACE_SPEED;
 
 			while (!isValidTrajectory && invalidTrajectoriesCounter % 500 != 499) {
-				// Create the trace starting from a bad painted pixel
-				unsigned int pixel = badPaintedPixels[floor(ofRandom(nBadPaintedPixels))];
-				glm::vec2 startingPosition = glm::vec2(pixel % imgWidth, pixel / imgWidth);
-				trace = ofxOilTrace(startingPosition, nSteps, TRACE_SPEED);
+				// Evaluate a new batch of candidates if all the previous ones have been processed
+				if (nextCandidate == nBatchCandidates) {
+					nBatchCandidates = searchBatchSize;
+					nextCandidate = 0;
+					evaluateCandidates(nBatchCandidates);
+				}
+
+				// Check if the candidate has a valid trajectory
+				isValidTrajectory = candidatesStatus[nextCandidate] != INVALID_TRAJECTORY;
 
-				// Check if the trace has a valid trajectory
-				isValidTrajectory = !alreadyVisitedTrajectory() && validTrajectory();
+				// Add the candidate evaluation statistics
+				stats += candidatesStats[nextCandidate];
 
-				// Increase the counter
+				// Increase the counters
 				++invalidTrajectoriesCounter;
+				++nextCandidate;
+				++nCandidates;
+
+				// Interrupt the search between invalid trajectories. The valid ones are checked below, after they are
+				// accepted or rejected.
+				if (!isValidTrajectory && interruptSearch()) {
+					return;
+				}
 			}
 
 			// Check if we have a valid trajectory
@@ -260,20 +923,25 @@ void ofxOilSimulator::getNewTrace() {
 				// Reset the invalid trajectories counter
 				invalidTrajectoriesCounter = 0;
 
-				// Set the trace brush size
-				trace.setBrushSize(brushSize);
+				// Check if painting the trace will improve the painting
+				if (candidatesStatus[nextCandidate - 1] == ACCEPTED) {
+					// Test passed, add the trace to the batch if it doesn't overlap the other batch traces
+					if (addToTraceBatch(candidates[nextCandidate - 1])) {
+						// The search is finished if we only needed the trace that follows the current one
+						if (prefetch) {
+							finishTraceBatch();
+							break;
+						}
 
-				// Calculate the trace average color and the bristle colors along the trajectory
-				trace.calculateAverageColor(img);
-				trace.calculateBristleColors(paintedPixels, BACKGROUND_COLOR);
+						// Reset the invalid traces counter, as if we started a new search
+						invalidTracesCounter = 0;
 
-				// Check if painting the trace will improve the painting
-				if (traceImprovesPainting()) {
-					// Test passed, the trace is good enough to be painted
-					obtainNewTrace = false;
-					traceStep = 0;
-					++nTraces;
-					break;
+						// Stop the search if the batch is complete
+						if (traceBatchRegions.size() >= max(1u, config->maxTracesPerUpdate)) {
+							finishTraceBatch();
+							break;
+						}
+					}
 				} else {
 					// The trace is not good enough, try again in the next loop step
 					++invalidTracesCounter;
@@ -282,24 +950,317 @@ void ofxOilSimulator::getNewTrace() {
 				// The trace is not good enough, try again in the next loop step
 				++invalidTracesCounter;
 			}
+
+			// Stop completing the batch if it takes too many candidates
+			if (!prefetch && !traceBatchRegions.empty()
+					&& nCandidates - traceBatchStartCandidate > config->maxTraceBatchCandidates) {
+				finishTraceBatch();
+				break;
+			}
+
+			// Interrupt the search after the rejected candidates with a valid trajectory too
+			if (interruptSearch()) {
+				return;
+			}
+		}
+	}
+}
+
+bool ofxOilSimulator::addToTraceBatch(ofxOilTrace& candidate) {
+	// The candidate was evaluated with the pixel arrays before painting the batch traces, so it can only be accepted
+	// if it doesn't touch any of them. The region margin covers the pixels rounding.
+	ofRectangle region = candidate.getPaintedRegion();
+	ofRectangle extendedRegion(region.x - 2, region.y - 2, region.width + 4, region.height + 4);
+	auto overlaps = [&extendedRegion](const ofRectangle& batchRegion) {
+		return extendedRegion.intersects(batchRegion);
+	};
+
+	if (any_of(traceBatchRegions.begin(), traceBatchRegions.end(), overlaps)
+			|| any_of(paintedRegions.begin(), paintedRegions.end(), overlaps)) {
+		--stats.accepted;
+		++stats.batchOverlapRejections;
+		return false;
+	}
+
+	// The first trace in the batch is painted first and the rest wait in the pending traces
+	if (traceBatchRegions.empty()) {
+		trace = move(candidate);
+		pendingTraces.clear();
+		nextPendingTrace = 0;
+		traceBatchStartCandidate = nCandidates;
+	} else {
+		// Remove the pending traces that have been painted already
+		if (nextPendingTrace == pendingTraces.size()) {
+			pendingTraces.clear();
+			nextPendingTrace = 0;
+		}
+
+		pendingTraces.push_back(move(candidate));
+	}
+
+	traceBatchRegions.push_back(region);
+	++nTraces;
+
+	// Record the trace in the stroke log if necessary
+	if (strokeLog) {
+		strokeLog->addTrace(traceBatchRegions.size() == 1 ? trace : pendingTraces.back());
+	}
+
+	return true;
+}
+
+void ofxOilSimulator::finishTraceBatch() {
+	// Start painting the first batch trace, unless we were searching while painting the current trace
+	if (obtainNewTrace) {
+		obtainNewTrace = false;
+		traceStep = 0;
+	}
+
+	searchInProgress = false;
+}
+
+void ofxOilSimulator::startNextTrace() {
+	// The finished trace region should be checked in the next pixel arrays update
+	paintedRegions.push_back(traceBatchRegions.front());
+	traceBatchRegions.erase(traceBatchRegions.begin());
+
+	// Update the pixel arrays right away if the search continues while the traces are painted. The candidates that
+	// were evaluated before are discarded, since the finished trace region is not reserved anymore.
+	bool pipelinedSearch = config->pipelinedSearchCandidates > 0;
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+	if (pipelinedSearch) {
+		updatePixelArrays();
+		stats.updatePixelArrays.addCall(start);
+		nextCandidate = nBatchCandidates;
+	}
+
+	if (nextPendingTrace < pendingTraces.size()) {
+		// Add the painted trace to the visited pixels and continue with the next trace in the batch. Without the
+		// pipelined search, the rest of the pixel arrays are updated only after the last batch trace is painted.
+		if (!pipelinedSearch) {
+			updateVisitedPixels();
+			stats.updatePixelArrays.addCall(start);
 		}
+
+		trace = move(pendingTraces[nextPendingTrace]);
+		++nextPendingTrace;
+		traceStep = 0;
+	} else {
+		// Obtain a new trace batch in the next update
+		pendingTraces.clear();
+		nextPendingTrace = 0;
+		obtainNewTrace = true;
 	}
 }
 
-bool ofxOilSimulator::alreadyVisitedTrajectory() const {
+void ofxOilSimulator::evaluateCandidates(unsigned int nBatchCandidates) {
+	// Make sure that the containers are big enough
+	if (candidates.size() < nBatchCandidates) {
+		candidates.resize(nBatchCandidates);
+		candidatesStatus.resize(nBatchCandidates);
+		candidatesStats.resize(nBatchCandidates);
+	}
+
+	// Calculate the image color variance at the current trace length scale if necessary
+	if (config->importanceSampling) {
+		int radius = round(0.5 * config->relativeTraceLength * averageBrushSize);
+
+		if (radius != varianceMap.getRadius()) {
+			chrono::steady_clock::time_point start = chrono::steady_clock::now();
+			varianceMap.calculate(img.getPixels(), radius);
+			stats.varianceMap.addCall(start);
+		}
+	}
+
+	// Calculate the image color standard deviation bound for the current brush size if necessary
+	if (config->seedPrefilter) {
+		// The candidate brush sizes and trace lengths are drawn around the average values, so the bound is calculated
+		// for the longest trajectory reach and the smallest number of samples of all of them. One more step is added
+		// at both ends of the steps range to cover the rounding errors.
+		auto getNSteps = [this](float brushFactor, float lengthFactor) {
+			float brushSize = max(config->smallerBrushSize, averageBrushSize * brushFactor);
+			return max(1u, (unsigned int) (max(config->minTraceLength,
+					config->relativeTraceLength * brushSize * lengthFactor) / config->traceSpeed));
+		};
+		unsigned int minNSamples = numeric_limits<unsigned int>::max();
+		float maxReach = 0;
+
+		for (unsigned int nSteps = max(getNSteps(0.95, 0.9), 2u) - 1, end = getNSteps(1.05, 1.1) + 1; nSteps <= end;
+				++nSteps) {
+			// Only the trajectory positions used to check the trajectory are sampled
+			float alphaDecrement = min(255.0 / nSteps, 25.0);
+			unsigned int lastSample = config->positionsForAverage;
+
+			while (lastSample < nSteps && (unsigned char) (255 - alphaDecrement * lastSample) >= config->minAlpha) {
+				++lastSample;
+			}
+
+			// Valid trajectories have a minimum fraction of their samples inside the image
+			unsigned int nTrajectorySamples = lastSample - config->positionsForAverage;
+			unsigned int nSamples = ceil(config->minInsideFractionInTrajectory * nTrajectorySamples);
+			minNSamples = min(minNSamples, nSamples);
+			maxReach = max(maxReach, lastSample * config->traceSpeed);
+		}
+
+		int radius = ceil(maxReach) + 1;
+
+		if (radius != stdevBoundMap.getRadius() || minNSamples != stdevBoundMap.getNSamples()) {
+			chrono::steady_clock::time_point start = chrono::steady_clock::now();
+			stdevBoundMap.calculate(img.getPixels(), radius, minNSamples);
+			stats.stdevBoundMap.addCall(start);
+		}
+	}
+
+	// Calculate the importance of the image pixels for the current brush size if necessary
+	if (config->importanceSampling && importanceMap.getBrushSize() != averageBrushSize) {
+		chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+		if (!importanceMap.hasImage()) {
+			importanceMap.setImage(img.getPixels(), config->importanceEdgeThreshold);
+		}
+
+		importanceMap.calculate(varianceMap, averageBrushSize, config->maxColorStdevInTrajectory,
+				config->importanceMinWeight);
+		stats.importanceMap.addCall(start);
+	}
+
+	// Create and evaluate the candidates, in parallel if possible
+	int imgWidth = img.getWidth();
+	uint64_t firstCandidateId = nCandidates;
+	uint64_t totalErrorWeight = config->errorWeightedSampling ? errorSampler.getTotalWeight() : 0;
+	auto evaluate = [this, imgWidth, firstCandidateId, totalErrorWeight](unsigned int i) {
+		// Each candidate has its own random number stream, derived from its position in the candidates sequence
+		ofxOilRandom candidateRandom = random.derive(firstCandidateId + i);
+		ofxOilSimulatorStats& candidateStats = candidatesStats[i];
+		candidateStats = ofxOilSimulatorStats();
+		chrono::steady_clock::time_point start = chrono::steady_clock::now();
+
+		// Create the trace starting from a bad painted pixel
+		float brushSize = max(config->smallerBrushSize, averageBrushSize * candidateRandom.nextFloat(0.95, 1.05));
+		float traceLength = config->relativeTraceLength * brushSize * candidateRandom.nextFloat(0.9, 1.1);
+		int nSteps = max(config->minTraceLength, traceLength) / config->traceSpeed;
+
+		// Draw a bad painted pixel uniformly or in proportion to its color error
+		auto drawPixel = [this, &candidateRandom, totalErrorWeight]() {
+			if (totalErrorWeight > 0) {
+				return errorSampler.find(candidateRandom.nextUInt64() % totalErrorWeight);
+			} else {
+				return getBadPaintedPixel(candidateRandom.nextIndex(nBadPaintedPixels));
+			}
+		};
+
+		unsigned int pixel = drawPixel();
+
+		// Draw the pixel again if it's not important for the current brush size, up to a maximum number of attempts
+		if (config->importanceSampling) {
+			for (unsigned int attempt = 1; attempt < config->importanceSamplingAttempts
+					&& candidateRandom.nextFloat() >= importanceMap.getWeight(pixel); ++attempt) {
+				pixel = drawPixel();
+			}
+		}
+
+		// Draw the pixel again if all the trajectories starting on it will have a too high color standard deviation,
+		// up to a maximum number of attempts. The discarded pixels are not counted as invalid trajectories.
+		if (config->seedPrefilter) {
+			for (unsigned int attempt = 1; attempt < config->seedPrefilterAttempts
+					&& stdevBoundMap.exceeds(pixel, config->maxColorStdevInTrajectory); ++attempt) {
+				++candidateStats.seedPrefilterRedraws;
+				pixel = drawPixel();
+			}
+		}
+
+		glm::vec2 startingPosition = glm::vec2(pixel % imgWidth, pixel / imgWidth);
+		candidates[i] = ofxOilTrace(startingPosition, nSteps, config->traceSpeed, candidateRandom, config);
+		candidates[i].setBrushSize(brushSize);
+		candidateStats.trajectoryGeneration.addCall(start);
+
+		// Evaluate the trace
+		candidatesStatus[i] = evaluateCandidate(candidates[i], candidateStats);
+	};
+
+	if (threadPool && nBatchCandidates > 1) {
+		threadPool->parallelFor(nBatchCandidates, evaluate);
+	} else {
+		for (unsigned int i = 0; i < nBatchCandidates; ++i) {
+			evaluate(i);
+		}
+	}
+}
+
+ofxOilSimulator::CandidateStatus ofxOilSimulator::evaluateCandidate(ofxOilTrace& candidate,
+		ofxOilSimulatorStats& candidateStats) const {
+	CandidateStatus status = ACCEPTED;
+	RejectionReason rejection = VISITED_REJECTION;
+
+	// Check if the trace has a valid trajectory
+	chrono::steady_clock::time_point start = chrono::steady_clock::now();
+	bool visited = alreadyVisitedTrajectory(candidate);
+	start = candidateStats.visitedTrajectoryCheck.addCall(start);
+
+	if (visited) {
+		status = INVALID_TRAJECTORY;
+	} else {
+		bool valid = validTrajectory(candidate, rejection);
+		start = candidateStats.validTrajectoryCheck.addCall(start);
+
+		if (!valid) {
+			status = INVALID_TRAJECTORY;
+		} else {
+			// Calculate the trace average color and the bristle colors along the trajectory
+			candidate.calculateAverageColor(img);
+			candidate.calculateBristleColors(getPaintedPixels(), config->backgroundColor);
+			start = candidateStats.colorsCalculation.addCall(start);
+
+			// Check if painting the trace will improve the painting
+			if (!traceImprovesPainting(candidate, rejection)) {
+				status = NO_IMPROVEMENT;
+			}
+
+			candidateStats.improvementCheck.addCall(start);
+		}
+	}
+
+	// Count the candidate evaluation result
+	if (status == ACCEPTED) {
+		++candidateStats.accepted;
+	} else {
+		switch (rejection) {
+		case VISITED_REJECTION:
+			++candidateStats.visitedRejections;
+			break;
+		case OUTSIDE_CANVAS_REJECTION:
+			++candidateStats.outsideCanvasRejections;
+			break;
+		case WELL_PAINTED_REJECTION:
+			++candidateStats.wellPaintedRejections;
+			break;
+		case HIGH_COLOR_STDEV_REJECTION:
+			++candidateStats.highColorStdevRejections;
+			break;
+		case NO_IMPROVEMENT_REJECTION:
+			++candidateStats.noImprovementRejections;
+			break;
+		}
+	}
+
+	return status;
+}
+
+bool ofxOilSimulator::alreadyVisitedTrajectory(const ofxOilTrace& candidate) const {
 	// Extract some useful information
-	const vector<glm::vec2>& positions = trace.getTrajectoryPositions();
-	const vector<unsigned char>& alphas = trace.getTrajectoryAphas();
-	int width = visitedPixels.getWidth();
-	int height = visitedPixels.getHeight();
+	const vector<glm::vec2>& positions = candidate.getTrajectoryPositions();
+	const vector<unsigned char>& alphas = candidate.getTrajectoryAphas();
+	int width = visitedMask.getWidth();
+	int height = visitedMask.getHeight();
 
 	// Check if the trace trajectory has been visited before
 	int insideCounter = 0;
 	int visitedCounter = 0;
 
-	for (unsigned int i = ofxOilBrush::POSITIONS_FOR_AVERAGE, nSteps = trace.getNSteps(); i < nSteps; ++i) {
+	for (unsigned int i = config->positionsForAverage, nSteps = candidate.getNSteps(); i < nSteps; ++i) {
 		// Check that the alpha value is high enough
-		if (alphas[i] >= ofxOilTrace::MIN_ALPHA) {
+		if (alphas[i] >= config->minAlpha) {
 			// Check that the position is inside the image
 			const glm::vec2& pos = positions[i];
 			int x = pos.x;
@@ -308,20 +1269,21 @@ bool ofxOilSimulator::alreadyVisitedTrajectory() const {
 			if (x >= 0 && x < width && y >= 0 && y < height) {
 				++insideCounter;
 
-				if (visitedPixels.getColor(x, y) == 0) {
+				if (visitedMask.get(x, y)) {
 					++visitedCounter;
 				}
 			}
 		}
 	}
 
-	return visitedCounter > MAX_VISITS_FRACTION_IN_TRAJECTORY * insideCounter;
+	return visitedCounter > config->maxVisitsFractionInTrajectory * insideCounter;
 }
 
-bool ofxOilSimulator::validTrajectory() const {
+bool ofxOilSimulator::validTrajectory(const ofxOilTrace& candidate, RejectionReason& rejection) const {
 	// Extract some useful information
-	const vector<glm::vec2>& positions = trace.getTrajectoryPositions();
-	const vector<unsigned char>& alphas = trace.getTrajectoryAphas();
+	const vector<glm::vec2>& positions = candidate.getTrajectoryPositions();
+	const vector<unsigned char>& alphas = candidate.getTrajectoryAphas();
+	const ofPixels& paintedPixels = getPaintedPixels();
 	int width = img.getWidth();
 	int height = img.getHeight();
 
@@ -336,9 +1298,9 @@ bool ofxOilSimulator::validTrajectory() const {
 	float imgBlueSum = 0;
 	float imgBlueSqSum = 0;
 
-	for (unsigned int i = ofxOilBrush::POSITIONS_FOR_AVERAGE, nSteps = trace.getNSteps(); i < nSteps; ++i) {
+	for (unsigned int i = config->positionsForAverage, nSteps = candidate.getNSteps(); i < nSteps; ++i) {
 		// Check that the alpha value is high enough
-		if (alphas[i] >= ofxOilTrace::MIN_ALPHA) {
+		if (alphas[i] >= config->minAlpha) {
 			// Check that the position is inside the image
 			const glm::vec2& pos = positions[i];
 			int x = pos.x;
@@ -347,15 +1309,20 @@ bool ofxOilSimulator::validTrajectory() const {
 			if (x >= 0 && x < width && y >= 0 && y < height) {
 				++insideCounter;
 
-				// Get the image color and the painted color at the trajectory position
+				// Get the image color at the trajectory position
 				const ofColor& imgColor = img.getColor(x, y);
-				const ofColor& paintedColor = paintedPixels.getColor(x, y);
 
-				// Check if the two colors are similar
-				if (paintedColor != BACKGROUND_COLOR && abs(imgColor.r - paintedColor.r) < MAX_COLOR_DIFFERENCE[0]
-						&& abs(imgColor.g - paintedColor.g) < MAX_COLOR_DIFFERENCE[1]
-						&& abs(imgColor.b - paintedColor.b) < MAX_COLOR_DIFFERENCE[2]) {
-					++similarColorCounter;
+				// Check if the painted color is similar to the image color. The pixels in the bad painted mask are
+				// never similar, and the rest could be outside the seed mask or region, so their colors are compared.
+				if (!badPaintedMask.get(x, y)) {
+					const ofColor& paintedColor = paintedPixels.getColor(x, y);
+
+					if (paintedColor != config->backgroundColor
+							&& abs(imgColor.r - paintedColor.r) < config->maxColorDifference[0]
+							&& abs(imgColor.g - paintedColor.g) < config->maxColorDifference[1]
+							&& abs(imgColor.b - paintedColor.b) < config->maxColorDifference[2]) {
+						++similarColorCounter;
+					}
 				}
 
 				// Extract the pixel color properties
@@ -386,20 +1353,34 @@ bool ofxOilSimulator::validTrajectory() const {
 	}
 
 	// Check if we have a valid trajectory
-	bool insideCanvas = insideCounter >= MIN_INSIDE_FRACTION_IN_TRAJECTORY * (insideCounter + outsideCounter);
-	bool badPainted = similarColorCounter <= MAX_SIMILAR_COLOR_FRACTION_IN_TRAJECTORY * insideCounter;
-	float maxSqDevSq = pow(MAX_COLOR_STDEV_IN_TRAJECTORY, 2);
+	bool insideCanvas = insideCounter >= config->minInsideFractionInTrajectory * (insideCounter + outsideCounter);
+	bool badPainted = similarColorCounter <= config->maxSimilarColorFractionInTrajectory * insideCounter;
+	float maxSqDevSq = pow(config->maxColorStdevInTrajectory, 2);
 	bool smallColorChange = imgRedStDevSq < maxSqDevSq && imgGreenStDevSq < maxSqDevSq && imgBlueStDevSq < maxSqDevSq;
 
+	// Set the rejection reason if necessary
+	if (!insideCanvas) {
+		rejection = OUTSIDE_CANVAS_REJECTION;
+	} else if (!badPainted) {
+		rejection = WELL_PAINTED_REJECTION;
+	} else if (!smallColorChange) {
+		rejection = HIGH_COLOR_STDEV_REJECTION;
+	}
+
 	return insideCanvas && badPainted && smallColorChange;
 }
 
-bool ofxOilSimulator::traceImprovesPainting() const {
+bool ofxOilSimulator::traceImprovesPainting(const ofxOilTrace& candidate, RejectionReason& rejection) const {
 	// Extract some useful information
-	const vector<unsigned char>& alphas = trace.getTrajectoryAphas();
-	const vector<vector<ofColor>>& bristleImgColors = trace.getBristleImageColors();
-	const vector<vector<ofColor>>& bristlePaintedColors = trace.getBristlePaintedColors();
-	const vector<vector<ofColor>>& bristleColors = trace.getBristleColors();
+	const vector<unsigned char>& alphas = candidate.getTrajectoryAphas();
+	const vector<unsigned char>& bristleSteps = candidate.getBristleSteps();
+	const ofxOilTrace::ColorPlanes& bristleImgColors = candidate.getBristleImageColors();
+	const ofxOilTrace::ColorPlanes& bristlePaintedColors = candidate.getBristlePaintedColors();
+	const ofxOilTrace::ColorPlanes& bristleColors = candidate.getBristleColors();
+	unsigned int nBristles = candidate.getNBristles();
+	int maxRedDiff = config->maxColorDifference[0];
+	int maxGreenDiff = config->maxColorDifference[1];
+	int maxBlueDiff = config->maxColorDifference[2];
 
 	// Obtain some trace statistics
 	int insideCounter = 0;
@@ -410,130 +1391,172 @@ bool ofxOilSimulator::traceImprovesPainting() const {
 	int destroyedSimilarColorCounter = 0;
 	int colorImprovement = 0;
 
-	for (unsigned int i = 0, nSteps = trace.getNSteps(); i < nSteps; ++i) {
-		// Check that the alpha value is high enough
-		if (alphas[i] >= ofxOilTrace::MIN_ALPHA) {
-			// Get the bristles image colors and painted colors for this step
-			const vector<ofColor>& bic = bristleImgColors[i];
-			const vector<ofColor>& bpc = bristlePaintedColors[i];
-			const vector<ofColor>& bc = bristleColors[i];
-
-			// Make sure that the containers are not empty
-			if (bic.size() > 0) {
-				for (unsigned int bristle = 0, nBristles = trace.getNBristles(); bristle < nBristles; ++bristle) {
-					// Get the image color and the painted color at the bristle position
-					const ofColor& imgColor = bic[bristle];
-					const ofColor& paintedColor = bpc[bristle];
-					const ofColor& bristleColor = bc[bristle];
-
-					// Check that the bristle is inside the image
-					if (imgColor.a != 0) {
-						++insideCounter;
-
-						// Count the number of painted pixels
-						bool paintedPixel = paintedColor.a != 0;
-
-						if (paintedPixel) {
-							++paintedCounter;
-						}
+	for (unsigned int i = 0, nSteps = candidate.getNSteps(); i < nSteps; ++i) {
+		// Check that the alpha value is high enough and that the step has bristle colors
+		if (alphas[i] < config->minAlpha || bristleSteps[i] == 0) {
+			continue;
+		}
 
-						// Count the number of painted pixels whose color is similar to the image color
-						int redPaintedDiff = abs(imgColor.r - paintedColor.r);
-						int greenPaintedDiff = abs(imgColor.g - paintedColor.g);
-						int bluePaintedDiff = abs(imgColor.b - paintedColor.b);
-						bool similarColorPixel = paintedPixel && redPaintedDiff < MAX_COLOR_DIFFERENCE[0]
-								&& greenPaintedDiff < MAX_COLOR_DIFFERENCE[1]
-								&& bluePaintedDiff < MAX_COLOR_DIFFERENCE[2];
+		// Get the bristles image colors, painted colors and bristle colors for this step
+		unsigned int offset = i * nBristles;
+		const unsigned char* imgRed = bristleImgColors.red.data() + offset;
+		const unsigned char* imgGreen = bristleImgColors.green.data() + offset;
+		const unsigned char* imgBlue = bristleImgColors.blue.data() + offset;
+		const unsigned char* imgAlpha = bristleImgColors.alpha.data() + offset;
+		const unsigned char* paintedRed = bristlePaintedColors.red.data() + offset;
+		const unsigned char* paintedGreen = bristlePaintedColors.green.data() + offset;
+		const unsigned char* paintedBlue = bristlePaintedColors.blue.data() + offset;
+		const unsigned char* paintedAlpha = bristlePaintedColors.alpha.data() + offset;
+		const unsigned char* red = bristleColors.red.data() + offset;
+		const unsigned char* green = bristleColors.green.data() + offset;
+		const unsigned char* blue = bristleColors.blue.data() + offset;
+
+		for (unsigned int bristle = 0; bristle < nBristles; ++bristle) {
+			// Check that the bristle is inside the image
+			if (imgAlpha[bristle] == 0) {
+				++outsideCounter;
+				continue;
+			}
 
-						if (similarColorPixel) {
-							++similarColorCounter;
-						}
+			++insideCounter;
 
-						// Count the number of pixels that will be well painted
-						int redAverageDiff = abs(imgColor.r - bristleColor.r);
-						int greenAverageDiff = abs(imgColor.g - bristleColor.g);
-						int blueAverageDiff = abs(imgColor.b - bristleColor.b);
-						bool wellPaintedPixel = redAverageDiff < MAX_COLOR_DIFFERENCE[0]
-								&& greenAverageDiff < MAX_COLOR_DIFFERENCE[1]
-								&& blueAverageDiff < MAX_COLOR_DIFFERENCE[2];
+			// Count the number of painted pixels
+			bool paintedPixel = paintedAlpha[bristle] != 0;
 
-						if (wellPaintedPixel) {
-							++wellPaintedCounter;
-						}
+			if (paintedPixel) {
+				++paintedCounter;
+			}
 
-						// Count the number of pixels that will not be well painted anymore
-						if (similarColorPixel && !wellPaintedPixel) {
-							++destroyedSimilarColorCounter;
-						}
+			// Count the number of painted pixels whose color is similar to the image color
+			int redPaintedDiff = abs(imgRed[bristle] - paintedRed[bristle]);
+			int greenPaintedDiff = abs(imgGreen[bristle] - paintedGreen[bristle]);
+			int bluePaintedDiff = abs(imgBlue[bristle] - paintedBlue[bristle]);
+			bool similarColorPixel = paintedPixel && redPaintedDiff < maxRedDiff && greenPaintedDiff < maxGreenDiff
+					&& bluePaintedDiff < maxBlueDiff;
 
-						// Calculate the color improvement
-						if (paintedPixel) {
-							colorImprovement += redPaintedDiff - redAverageDiff + greenPaintedDiff - greenAverageDiff
-									+ bluePaintedDiff - blueAverageDiff;
-						}
-					} else {
-						++outsideCounter;
-					}
-				}
+			if (similarColorPixel) {
+				++similarColorCounter;
+			}
+
+			// Count the number of pixels that will be well painted
+			int redAverageDiff = abs(imgRed[bristle] - red[bristle]);
+			int greenAverageDiff = abs(imgGreen[bristle] - green[bristle]);
+			int blueAverageDiff = abs(imgBlue[bristle] - blue[bristle]);
+			bool wellPaintedPixel = redAverageDiff < maxRedDiff && greenAverageDiff < maxGreenDiff
+					&& blueAverageDiff < maxBlueDiff;
+
+			if (wellPaintedPixel) {
+				++wellPaintedCounter;
+			}
+
+			// Count the number of pixels that will not be well painted anymore
+			if (similarColorPixel && !wellPaintedPixel) {
+				++destroyedSimilarColorCounter;
+			}
+
+			// Calculate the color improvement
+			if (paintedPixel) {
+				colorImprovement += redPaintedDiff - redAverageDiff + greenPaintedDiff - greenAverageDiff
+						+ bluePaintedDiff - blueAverageDiff;
 			}
 		}
 	}
 
 	int wellPaintedImprovement = wellPaintedCounter - similarColorCounter;
 	int previouslyBadPainted = insideCounter - similarColorCounter;
-	float averageMaxColorDiff = (MAX_COLOR_DIFFERENCE[0] + MAX_COLOR_DIFFERENCE[1] + MAX_COLOR_DIFFERENCE[2]) / 3.0;
-
-	bool outsideCanvas = insideCounter < MIN_INSIDE_FRACTION * (insideCounter + outsideCounter);
-	bool alreadyWellPainted = similarColorCounter > MAX_SIMILAR_COLOR_FRACTION * insideCounter;
-	bool alreadyPainted = paintedCounter >= MAX_PAINTED_FRACTION * insideCounter;
-	bool colorImproves = colorImprovement >= MIN_COLOR_IMPROVEMENT_FACTOR * averageMaxColorDiff * paintedCounter;
-	bool bigWellPaintedImprovement = wellPaintedImprovement >= BIG_WELL_PAINTED_IMPROVEMENT_FRACTION * insideCounter;
-	bool reducedBadPainted = wellPaintedImprovement >= MIN_BAD_PAINTED_REDUCTION_FRACTION * previouslyBadPainted;
+	const array<int, 3>& maxColorDifference = config->maxColorDifference;
+	float averageMaxColorDiff = (maxColorDifference[0] + maxColorDifference[1] + maxColorDifference[2]) / 3.0;
+
+	bool outsideCanvas = insideCounter < config->minInsideFraction * (insideCounter + outsideCounter);
+	bool alreadyWellPainted = similarColorCounter > config->maxSimilarColorFraction * insideCounter;
+	bool alreadyPainted = paintedCounter >= config->maxPaintedFraction * insideCounter;
+	bool colorImproves = colorImprovement >= config->minColorImprovementFactor * averageMaxColorDiff * paintedCounter;
+	bool bigWellPaintedImprovement = wellPaintedImprovement
+			>= config->bigWellPaintedImprovementFraction * insideCounter;
+	bool reducedBadPainted = wellPaintedImprovement >= config->minBadPaintedReductionFraction * previouslyBadPainted;
 	bool lowWellPaintedDestruction = destroyedSimilarColorCounter
-			<= MAX_WELL_PAINTED_DESTRUCTION_FRACTION * wellPaintedImprovement;
+			<= config->maxWellPaintedDestructionFraction * wellPaintedImprovement;
 	bool improves = (colorImproves || bigWellPaintedImprovement) && reducedBadPainted && lowWellPaintedDestruction;
 
 	// Check if the trace will improve the painting
+	if (outsideCanvas) {
+		rejection = OUTSIDE_CANVAS_REJECTION;
+	} else if (alreadyWellPainted) {
+		rejection = WELL_PAINTED_REJECTION;
+	} else if (alreadyPainted && !improves) {
+		rejection = NO_IMPROVEMENT_REJECTION;
+	}
+
 	return (outsideCanvas || alreadyWellPainted || (alreadyPainted && !improves)) ? false : true;
 }
 
 void ofxOilSimulator::paintTrace() {
 	// Pain the trace in the canvas and the canvas buffer if necessary
-	canvas.begin();
-	useCanvasBuffer ? trace.paint(canvasBuffer) : trace.paint();
-	canvas.end();
+	canvas->begin();
+	useCanvasBuffer ? trace.paint(*canvas, *canvasBuffer) : trace.paint(*canvas);
+	canvas->end();
 }
 
 void ofxOilSimulator::paintTraceStep() {
 	// Pain the trace step in the canvas and the canvas buffer if necessary
-	canvas.begin();
-	useCanvasBuffer ? trace.paintStep(traceStep, canvasBuffer) : trace.paintStep(traceStep);
-	canvas.end();
+	canvas->begin();
+	useCanvasBuffer ? trace.paintStep(traceStep, *canvas, *canvasBuffer) : trace.paintStep(traceStep, *canvas);
+	canvas->end();
 
 	// Increment the trace step
 	++traceStep;
 }
 
 void ofxOilSimulator::drawCanvas(float x, float y) const {
-	canvas.draw(x, y);
+	canvas->draw(x, y);
 }
 
 void ofxOilSimulator::drawImage(float x, float y) const {
-	img.draw(x, y);
+	if (img.isUsingTexture()) {
+		img.draw(x, y);
+	} else {
+		ofImage imgWithTexture;
+		imgWithTexture.setFromPixels(img.getPixels());
+		imgWithTexture.draw(x, y);
+	}
 }
 
 void ofxOilSimulator::drawVisitedPixels(float x, float y) const {
 	ofImage visitedPixelsImg;
-	visitedPixelsImg.setFromPixels(visitedPixels);
+	visitedPixelsImg.setFromPixels(visitedMask.getPixels(0, 255));
 	visitedPixelsImg.draw(x, y);
 }
 
 void ofxOilSimulator::drawSimilarColorPixels(float x, float y) const {
 	ofImage similarColorPixelsImg;
-	similarColorPixelsImg.setFromPixels(similarColorPixels);
+	similarColorPixelsImg.setFromPixels(badPaintedMask.getPixels(255, 0));
 	similarColorPixelsImg.draw(x, y);
 }
 
 bool ofxOilSimulator::isFinished() const {
 	return paintingIsFinised;
 }
+
+unsigned int ofxOilSimulator::getNTraces() const {
+	return nTraces;
+}
+
+float ofxOilSimulator::getChangedFraction() const {
+	return changedFraction;
+}
+
+uint64_t ofxOilSimulator::getNCandidates() const {
+	return nCandidates;
+}
+
+float ofxOilSimulator::getAverageBrushSize() const {
+	return averageBrushSize;
+}
+
+const ofxOilSimulatorStats& ofxOilSimulator::getStats() const {
+	return stats;
+}
+
+void ofxOilSimulator::resetStats() {
+	stats = ofxOilSimulatorStats();
+}
@@ -2,6 +2,17 @@
 
 #include "ofMain.h"
 #include "ofxOilTrace.h"
+#include "ofxOilCanvas.h"
+#include "ofxOilThreadPool.h"
+#include "ofxOilRandom.h"
+#include "ofxOilConfig.h"
+#include "ofxOilSimulatorStats.h"
+#include "ofxOilStrokeLogWriter.h"
+#include "ofxOilVarianceMap.h"
+#include "ofxOilStdevBoundMap.h"
+#include "ofxOilImportanceMap.h"
+#include "ofxOilWeightedSampler.h"
+#include "ofxOilBitMask.h"
 
 /**
  * @brief Class used to simulate an oil paint
@@ -12,143 +23,187 @@ class ofxOilSimulator {
 public:
 
 	/**
-	 * @brief The smaller brush size allowed
+	 * @brief The possible evaluation status of a candidate trace
 	 */
-	static float SMALLER_BRUSH_SIZE;
+	enum CandidateStatus {
+		INVALID_TRAJECTORY, NO_IMPROVEMENT, ACCEPTED
+	};
 
 	/**
-	 * @brief The brush size decrement ratio
+	 * @brief The possible reasons to reject a candidate trace
 	 */
-	static float BRUSH_SIZE_DECREMENT;
+	enum RejectionReason {
+		VISITED_REJECTION, OUTSIDE_CANVAS_REJECTION, WELL_PAINTED_REJECTION, HIGH_COLOR_STDEV_REJECTION,
+		NO_IMPROVEMENT_REJECTION
+	};
 
 	/**
-	 * @brief The maximum number of invalid trajectories allowed before the brush size is reduced
-	 */
-	static unsigned int MAX_INVALID_TRAJECTORIES;
-
-	/**
-	 * @brief The maximum number of invalid trajectories allowed for the smaller brush size before the painting is finished
-	 */
-	static unsigned int MAX_INVALID_TRAJECTORIES_FOR_SMALLER_SIZE;
-
-	/**
-	 * @brief The maximum number of invalid traces allowed before the brush size is reduced
-	 */
-	static unsigned int MAX_INVALID_TRACES;
-
-	/**
-	 * @brief The maximum number of invalid traces allowed for the smaller brush size before the painting is finished
-	 */
-	static unsigned int MAX_INVALID_TRACES_FOR_SMALLER_SIZE;
-
-	/**
-	 * @brief The trace speed in pixels/step
+	 * @brief Constructor
+	 *
+	 * @param _useCanvasBuffer sets if the simulator should use a canvas buffer for the color mixing calculation
+	 * @param _verbose sets if the simulator should print some debugging information
+	 * @param _canvasType the type of canvas where the oil painting is done. Use OFX_OIL_CANVAS_PIXELS to paint on the
+	 * CPU without an OpenGL context.
+	 * @param _config the simulation parameters. The simulator keeps its own copy, which cannot be modified.
 	 */
-	static float TRACE_SPEED;
+	ofxOilSimulator(bool _useCanvasBuffer = true, bool _verbose = true,
+			ofxOilCanvasType _canvasType = OFX_OIL_CANVAS_FBO, const ofxOilConfig& _config = ofxOilConfig());
 
 	/**
-	 * @brief The typical trace length, relative to the brush size
+	 * @brief Returns the simulation parameters
+	 *
+	 * @return the simulation parameters
 	 */
-	static float RELATIVE_TRACE_LENGTH;
+	const ofxOilConfig& getConfig() const;
 
 	/**
-	 * @brief The minimum trace length allowed
+	 * @brief Sets the pixels of the image that should be painted
+	 *
+	 * @param imagePixels the pixels of the image that should be painted
+	 * @param clearCanvas if true the canvas will be cleared before the painting starts
 	 */
-	static float MIN_TRACE_LENGTH;
+	void setImagePixels(const ofPixels& imagePixels, bool clearCanvas);
 
 	/**
-	 * @brief The canvas background color
+	 * @brief Sets the image that should be painted
+	 *
+	 * @param image the image that should be painted
+	 * @param clearCanvas if true the canvas will be cleared before the painting starts
 	 */
-	static ofColor BACKGROUND_COLOR;
+	void setImage(const ofImage& image, bool clearCanvas);
 
 	/**
-	 * @brief The maximum color difference between the painted image and the already painted color to consider it well
-	 * painted
+	 * @brief Sets the pixels of a new video frame that should be painted over the current canvas
+	 *
+	 * The frame is compared with the image that is being painted in square blocks. Only the blocks that changed are
+	 * copied into the image and repainted, starting with an average brush size that matches the area still to repaint.
+	 * The blocks that didn't change keep their previous image pixels, so slow changes accumulate until they are large
+	 * enough to be repainted. The changed blocks are repainted until the painting finishes, even if the next frames
+	 * don't change them again. The first frame, or a frame with different dimensions, is painted from scratch on a
+	 * clean canvas.
+	 *
+	 * @param framePixels the pixels of the video frame that should be painted
 	 */
-	static array<int, 3> MAX_COLOR_DIFFERENCE;
+	void setVideoFramePixels(const ofPixels& framePixels);
 
 	/**
-	 * @brief The maximum allowed fraction of pixels in the trace trajectory that have been visited before
+	 * @brief Sets a new video frame that should be painted over the current canvas
+	 *
+	 * @param frame the video frame that should be painted
 	 */
-	static float MAX_VISITS_FRACTION_IN_TRAJECTORY;
+	void setVideoFrame(const ofImage& frame);
 
 	/**
-	 * @brief The minimum fraction of pixels in the trace trajectory that should fall inside the canvas
+	 * @brief Replaces the canvas pixels, so the simulation can continue painting over them
+	 *
+	 * Note that the setImagePixels method should have been run before, since the pixels dimensions should coincide
+	 * with the image dimensions.
+	 *
+	 * @param canvasPixels the new canvas pixels
+	 * @param canvasBufferPixels the new canvas buffer pixels. They are ignored if the canvas buffer is not used.
 	 */
-	static float MIN_INSIDE_FRACTION_IN_TRAJECTORY;
+	void setCanvasPixels(const ofPixels& canvasPixels, const ofPixels& canvasBufferPixels);
 
 	/**
-	 * @brief The maximum allowed fraction of pixels in the trace trajectory with colors similar to the painted image
+	 * @brief Returns the canvas pixels
+	 *
+	 * @return the canvas pixels
 	 */
-	static float MAX_SIMILAR_COLOR_FRACTION_IN_TRAJECTORY;
+	const ofPixels& getCanvasPixels();
 
 	/**
-	 * @brief The maximum allowed value of the colors standard deviation along the trace trajectory
+	 * @brief Returns the canvas buffer pixels
+	 *
+	 * @return the canvas buffer pixels, or the canvas pixels if the canvas buffer is not used
 	 */
-	static float MAX_COLOR_STDEV_IN_TRAJECTORY;
+	const ofPixels& getCanvasBufferPixels();
 
 	/**
-	 * @brief The minimum fraction of pixels in the trace that should fall inside the canvas
+	 * @brief Restricts the canvas region where the traces can start
+	 *
+	 * The traces can still extend outside the region. The painting is finished when all the region pixels are well
+	 * painted or too many candidate traces were rejected.
+	 *
+	 * @param region the region where the traces can start. Use an empty rectangle to use the whole canvas.
 	 */
-	static float MIN_INSIDE_FRACTION;
+	void setSeedRegion(const ofRectangle& region);
 
 	/**
-	 * @brief The maximum fraction of pixels in the trace with colors similar to the painted image
+	 * @brief Sets the seed of the simulator random number stream
+	 *
+	 * Each candidate trace uses a random number stream derived from the simulator stream and its position in the
+	 * candidates sequence, so the painting obtained for a given seed and image is always the same.
+	 *
+	 * @param seed the random number stream seed
 	 */
-	static float MAX_SIMILAR_COLOR_FRACTION;
+	void setSeed(uint64_t seed);
 
 	/**
-	 * @brief The maximum fraction of pixels in the trace that has been painted already
+	 * @brief Returns the seed of the simulator random number stream
+	 *
+	 * @return the random number stream seed
 	 */
-	static float MAX_PAINTED_FRACTION;
+	uint64_t getSeed() const;
 
 	/**
-	 * @brief The minimum color improvement factor of the already painted pixels required to paint the trace on the
-	 * canvas
+	 * @brief Sets the number of threads used to check all the canvas pixels and to evaluate the candidate traces
+	 *
+	 * @param nThreads the number of threads. Use 1 to run everything in the calling thread. If zero, the number of
+	 * hardware threads will be used.
 	 */
-	static float MIN_COLOR_IMPROVEMENT_FACTOR;
+	void setNThreads(unsigned int nThreads);
 
 	/**
-	 * @brief The minimum improvement fraction in the number of well painted pixels to consider to paint the trace even
-	 * if there is not a significant color improvement
+	 * @brief Sets the number of candidate traces that are evaluated at once when searching for a new trace
+	 *
+	 * The candidates are evaluated in parallel against the current pixel arrays and they are processed afterwards in
+	 * order, as if they were evaluated one after the other. The candidates that are not processed are discarded and
+	 * created again in the next search, so the painting obtained for a given seed doesn't depend on the batch size or
+	 * the number of threads.
+	 *
+	 * @param batchSize the number of candidate traces evaluated at once. Use 1 to evaluate them sequentially.
+	 * @param nThreads the number of threads used to evaluate the candidates, only used if the batch size is larger
+	 * than one. If zero, the number of hardware threads will be used.
 	 */
-	static float BIG_WELL_PAINTED_IMPROVEMENT_FRACTION;
+	void setSpeculativeSearch(unsigned int batchSize, unsigned int nThreads = 0);
 
 	/**
-	 * @brief The minimum reduction fraction in the number of bad painted pixels required to paint the trace on the
-	 * canvas
+	 * @brief Starts recording the accepted traces in a stroke log
+	 *
+	 * Note that the setImagePixels method should have been run before, since the log header contains the canvas
+	 * dimensions. The log can be replayed with ofxOilStrokeLogReader.
+	 *
+	 * @param path the stroke log file path
 	 */
-	static float MIN_BAD_PAINTED_REDUCTION_FRACTION;
+	void startStrokeLog(const string& path);
 
 	/**
-	 * @brief The maximum allowed fraction of pixels in the trace that were previously well painted and will be now bad
-	 * painted
+	 * @brief Stops recording the accepted traces and closes the stroke log
 	 */
-	static float MAX_WELL_PAINTED_DESTRUCTION_FRACTION;
+	void stopStrokeLog();
 
 	/**
-	 * @brief Constructor
+	 * @brief Saves the simulator state in a checkpoint file
 	 *
-	 * @param _useCanvasBuffer sets if the simulator should use a canvas buffer for the color mixing calculation
-	 * @param _verbose sets if the simulator should print some debugging information
-	 */
-	ofxOilSimulator(bool _useCanvasBuffer = true, bool _verbose = true);
-
-	/**
-	 * @brief Sets the pixels of the image that should be painted
+	 * The file contains the canvas, the canvas buffer, the visited pixels, the average brush size, the trace counters
+	 * and the random number stream state. If a trace is being painted step by step, it is finished before saving the
+	 * state, together with the accepted traces that are waiting to be painted. The file is written first to a
+	 * temporary file and then renamed, so an interrupted save doesn't destroy the previous checkpoint.
 	 *
-	 * @param imagePixels the pixels of the image that should be painted
-	 * @param clearCanvas if true the canvas will be cleared before the painting starts
+	 * @param path the checkpoint file path
 	 */
-	void setImagePixels(const ofPixels& imagePixels, bool clearCanvas);
+	void saveState(const string& path);
 
 	/**
-	 * @brief Sets the image that should be painted
+	 * @brief Loads the simulator state from a checkpoint file, so the simulation can continue where it was saved
 	 *
-	 * @param image the image that should be painted
-	 * @param clearCanvas if true the canvas will be cleared before the painting starts
+	 * The file is mapped in memory. Note that the setImagePixels method should have been run before with the same
+	 * image that was used to save the state, and the simulator should use the same simulation parameters. The bad
+	 * painted pixels are obtained again in the next update.
+	 *
+	 * @param path the checkpoint file path
 	 */
-	void setImage(const ofImage& image, bool clearCanvas);
+	void loadState(const string& path);
 
 	/**
 	 * @brief Updates the simulation
@@ -158,6 +213,18 @@ public:
 	 */
 	void update(bool stepByStep);
 
+	/**
+	 * @brief Updates the simulation during a given amount of time
+	 *
+	 * The traces are painted step by step until the time budget is consumed, so an application can keep a steady frame
+	 * rate while the painting converges. The candidate search checks the time after each candidate and continues in
+	 * the next update if the budget is consumed before a valid trace is found. At least one trace step or candidate is
+	 * processed in each update, and the painted result doesn't depend on the budget.
+	 *
+	 * @param microseconds the time budget in microseconds
+	 */
+	void updateWithBudget(unsigned int microseconds);
+
 	/**
 	 * @brief Draws the canvas on the screen
 	 *
@@ -197,8 +264,70 @@ public:
 	 */
 	bool isFinished() const;
 
+	/**
+	 * @brief Returns the total number of painted traces
+	 *
+	 * @return the total number of painted traces
+	 */
+	unsigned int getNTraces() const;
+
+	/**
+	 * @brief Returns the fraction of the canvas that changed in the last video frame
+	 *
+	 * @return the fraction of the canvas that changed in the last video frame
+	 */
+	float getChangedFraction() const;
+
+	/**
+	 * @brief Returns the total number of candidate traces processed since the seed was set
+	 *
+	 * @return the total number of candidate traces processed, including the accepted ones
+	 */
+	uint64_t getNCandidates() const;
+
+	/**
+	 * @brief Returns the current average brush size
+	 *
+	 * @return the current average brush size
+	 */
+	float getAverageBrushSize() const;
+
+	/**
+	 * @brief Returns the simulator timing and candidate rejection statistics
+	 *
+	 * @return the statistics accumulated since the simulator was created or the statistics were reset
+	 */
+	const ofxOilSimulatorStats& getStats() const;
+
+	/**
+	 * @brief Resets the simulator timing and candidate rejection statistics
+	 */
+	void resetStats();
+
 protected:
 
+	/**
+	 * @brief The simulator state file format identifier, written at the beginning of the file
+	 */
+	static const char STATE_MAGIC[4];
+
+	/**
+	 * @brief The simulator state file format version
+	 */
+	static const uint32_t STATE_VERSION = 1;
+
+	/**
+	 * @brief The size in pixels of the canvas tiles used to count the bad painted pixels
+	 */
+	static const int BAD_PAINTED_TILE_SIZE = 64;
+
+	/**
+	 * @brief Returns the pixels used for the color mixing calculation
+	 *
+	 * @return the canvas buffer pixels if the canvas buffer is used, the canvas pixels otherwise
+	 */
+	const ofPixels& getPaintedPixels() const;
+
 	/**
 	 * @brief Updates the pixel arrays
 	 */
@@ -209,17 +338,135 @@ protected:
 	 */
 	void updateVisitedPixels();
 
+	/**
+	 * @brief Marks in the seed mask the blocks where a new video frame differs from the current image, and copies
+	 * them into the image
+	 *
+	 * The blocks marked by previous frames stay marked until the painting is finished.
+	 *
+	 * @param framePixels the video frame pixels in RGB format
+	 * @param nMarkedPixels the number of pixels inside all the marked blocks, including the previously marked ones
+	 * @return the number of pixels inside the changed blocks
+	 */
+	unsigned int markChangedBlocks(const ofPixels& framePixels, unsigned int& nMarkedPixels);
+
+	/**
+	 * @brief Checks all the similar color pixels inside a given canvas region and rebuilds the bad painted tiles
+	 *
+	 * The region is divided in chunks of rows that are processed in parallel if the simulator has a thread pool.
+	 * Each chunk writes complete rows of the bad painted mask, so the chunks never share mask words.
+	 *
+	 * @param xMin the region minimum x pixel coordinate
+	 * @param yMin the region minimum y pixel coordinate
+	 * @param xMax the region maximum x pixel coordinate (not included)
+	 * @param yMax the region maximum y pixel coordinate (not included)
+	 */
+	void scanSimilarColorPixels(int xMin, int yMin, int xMax, int yMax);
+
+	/**
+	 * @brief Updates the bad painted mask and the bad painted tiles inside a given canvas region
+	 *
+	 * @param xMin the region minimum x pixel coordinate
+	 * @param yMin the region minimum y pixel coordinate
+	 * @param xMax the region maximum x pixel coordinate (not included)
+	 * @param yMax the region maximum y pixel coordinate (not included)
+	 */
+	void updateSimilarColorPixels(int xMin, int yMin, int xMax, int yMax);
+
+	/**
+	 * @brief Calculates the error weight of a bad painted pixel, used to draw the trace starting pixels
+	 *
+	 * @param imgColor the image pixel color in RGB format
+	 * @param paintedColor the painted pixel color in RGB format
+	 * @return the pixel error weight: one plus the sum of the absolute color channel differences
+	 */
+	static unsigned short getErrorWeight(const unsigned char* imgColor, const unsigned char* paintedColor);
+
+	/**
+	 * @brief Counts again the bad painted pixels in the canvas tiles that overlap a region
+	 *
+	 * @param xMin the region minimum x coordinate (included)
+	 * @param yMin the region minimum y coordinate (included)
+	 * @param xMax the region maximum x coordinate (not included)
+	 * @param yMax the region maximum y coordinate (not included)
+	 */
+	void updateBadPaintedTiles(int xMin, int yMin, int xMax, int yMax);
+
+	/**
+	 * @brief Returns the index of a bad painted pixel
+	 *
+	 * @param index the bad painted pixel index, between 0 (included) and the number of bad painted pixels (not
+	 * included). The pixels are ordered by canvas tile and then by row.
+	 * @return the pixel index (y * width + x)
+	 */
+	unsigned int getBadPaintedPixel(unsigned int index) const;
+
+	/**
+	 * @brief Updates the simulation, stopping the candidate search if a given deadline is reached
+	 *
+	 * @param stepByStep if true only one single step of the current trace will be painted
+	 * @param deadline the time when the candidate search should be interrupted
+	 */
+	void updateUntil(bool stepByStep, const chrono::steady_clock::time_point& deadline);
+
 	/**
 	 * @brief Gets a new trace for the simulation
+	 *
+	 * If the deadline or the candidates limit are reached before a valid trace is found, the search is interrupted and
+	 * it will continue from the same point in the next call.
+	 *
+	 * @param deadline the time when the search should be interrupted
+	 * @param candidatesLimit the value of the candidates counter when the search should be interrupted
+	 * @param prefetch if true the search looks for the trace that will follow the current trace, while the current
+	 * trace is painted. The found trace is added to the pending traces, and the brush size changes and the end of the
+	 * painting are left to the search that starts after the current trace is painted.
+	 */
+	void getNewTrace(const chrono::steady_clock::time_point& deadline, uint64_t candidatesLimit, bool prefetch);
+
+	/**
+	 * @brief Adds an accepted candidate to the batch of traces painted before the next pixel arrays update
+	 *
+	 * @param candidate the accepted candidate. It is moved to the batch if it doesn't overlap the other batch traces.
+	 * @return true if the candidate was added to the batch
+	 */
+	bool addToTraceBatch(ofxOilTrace& candidate);
+
+	/**
+	 * @brief Finishes the trace search and starts painting the traces in the batch
+	 */
+	void finishTraceBatch();
+
+	/**
+	 * @brief Starts painting the next trace in the batch, or requests a new trace batch if all have been painted
+	 */
+	void startNextTrace();
+
+	/**
+	 * @brief Creates and evaluates a new batch of candidate traces
+	 *
+	 * @param nBatchCandidates the number of candidate traces in the batch
+	 */
+	void evaluateCandidates(unsigned int nBatchCandidates);
+
+	/**
+	 * @brief Evaluates if a candidate trace can be painted on the canvas
+	 *
+	 * This method only reads the simulator pixel arrays, so it can be run in parallel for different candidates.
+	 *
+	 * @param candidate the candidate trace. Its average and bristle colors will be calculated if it has a valid
+	 * trajectory.
+	 * @param candidateStats the statistics where the evaluation phases and the candidate status will be added
+	 * @return the candidate evaluation status
 	 */
-	void getNewTrace();
+	CandidateStatus evaluateCandidate(ofxOilTrace& candidate, ofxOilSimulatorStats& candidateStats) const;
 
 	/**
 	 * @brief Checks if the trace trajectory falls in a region that has been visited before
 	 *
+	 * @param candidate the trace to check
 	 * @return true if the trace trajectory falls in a region that has been visited before
 	 */
-	bool alreadyVisitedTrajectory() const;
+	bool alreadyVisitedTrajectory(const ofxOilTrace& candidate) const;
 
 	/**
 	 * @brief Checks if the trace trajectory is valid
@@ -227,19 +474,23 @@ protected:
 	 * To be valid it should fall on a region that was not painted correctly before, it should fall most of the time
 	 * inside the canvas, and the image color changes should be small.
 	 *
+	 * @param candidate the trace to check
+	 * @param rejection the rejection reason. It is only set if the trajectory is not valid.
 	 * @return true if the trace has a valid trajectory
 	 */
-	bool validTrajectory() const;
+	bool validTrajectory(const ofxOilTrace& candidate, RejectionReason& rejection) const;
 
 	/**
 	 * @brief Checks if drawing the trace will improve the overall painting
 	 *
-	 * Note that the calculateBristleColors method should have been run before.
+	 * Note that the calculateBristleColors method should have been run before on the trace.
 	 *
+	 * @param candidate the trace to check
+	 * @param rejection the rejection reason. It is only set if the trace doesn't improve the painting.
 	 * @return false if the region covered by the trace was already painted with similar colors, most of the trace is
 	 *         outside the canvas, or drawing the trace will not improve considerably the painting
 	 */
-	bool traceImprovesPainting() const;
+	bool traceImprovesPainting(const ofxOilTrace& candidate, RejectionReason& rejection) const;
 
 	/**
 	 * @brief Paints the current trace
@@ -251,6 +502,11 @@ protected:
 	 */
 	void paintTraceStep();
 
+	/**
+	 * @brief The simulation parameters, shared with the simulator traces
+	 */
+	shared_ptr<const ofxOilConfig> config;
+
 	/**
 	 * @brief Sets if a canvas buffer should be used for the color mixing calculation
 	 */
@@ -261,6 +517,56 @@ protected:
 	 */
 	bool verbose;
 
+	/**
+	 * @brief The simulator random number stream
+	 */
+	ofxOilRandom random;
+
+	/**
+	 * @brief The total number of candidate traces processed since the seed was set
+	 */
+	uint64_t nCandidates;
+
+	/**
+	 * @brief The number of candidate traces evaluated at once when searching for a new trace
+	 */
+	unsigned int searchBatchSize;
+
+	/**
+	 * @brief The thread pool used to check the canvas pixels and evaluate the candidate traces in parallel
+	 */
+	unique_ptr<ofxOilThreadPool> threadPool;
+
+	/**
+	 * @brief The stroke log where the accepted traces are recorded
+	 */
+	unique_ptr<ofxOilStrokeLogWriter> strokeLog;
+
+	/**
+	 * @brief The current batch of candidate traces
+	 */
+	vector<ofxOilTrace> candidates;
+
+	/**
+	 * @brief The evaluation status of each candidate trace in the current batch
+	 */
+	vector<CandidateStatus> candidatesStatus;
+
+	/**
+	 * @brief The evaluation statistics of each candidate trace in the current batch
+	 */
+	vector<ofxOilSimulatorStats> candidatesStats;
+
+	/**
+	 * @brief The simulator timing and candidate rejection statistics
+	 */
+	ofxOilSimulatorStats stats;
+
+	/**
+	 * @brief The type of canvas where the oil painting is done
+	 */
+	ofxOilCanvasType canvasType;
+
 	/**
 	 * @brief The image to paint
 	 */
@@ -269,32 +575,79 @@ protected:
 	/**
 	 * @brief The canvas where the oil painting is done
 	 */
-	ofFbo canvas;
+	unique_ptr<ofxOilCanvas> canvas;
 
 	/**
 	 * @brief The canvas buffer used for the color mixing calculation
 	 */
-	ofFbo canvasBuffer;
+	unique_ptr<ofxOilCanvas> canvasBuffer;
+
+	/**
+	 * @brief Mask indicating which canvas pixels have been visited by previous traces
+	 */
+	ofxOilBitMask visitedMask;
+
+	/**
+	 * @brief Mask indicating which painted pixels can be used as trace starting pixels, because their colors are not
+	 * similar to the original image
+	 */
+	ofxOilBitMask badPaintedMask;
+
+	/**
+	 * @brief The image color standard deviation around each pixel, used by the importance sampling
+	 */
+	ofxOilVarianceMap varianceMap;
+
+	/**
+	 * @brief The lower bound of the image color standard deviation along the trajectories starting on each pixel,
+	 * used to filter the trace starting pixels
+	 */
+	ofxOilStdevBoundMap stdevBoundMap;
+
+	/**
+	 * @brief The importance of each image pixel as a trace starting pixel for the current brush size
+	 */
+	ofxOilImportanceMap importanceMap;
+
+	/**
+	 * @brief The canvas region where the traces can start. If empty, the whole canvas is used.
+	 */
+	ofRectangle seedRegion;
+
+	/**
+	 * @brief Indicates if all the similar color pixels should be checked in the next pixel arrays update
+	 */
+	bool fullPixelArraysUpdate;
+
+	/**
+	 * @brief Container indicating the pixels where the traces can start: 255 if they can start, 0 otherwise
+	 */
+	ofPixels seedMaskPixels;
+
+	/**
+	 * @brief Indicates if the seed mask should be used
+	 */
+	bool useSeedMask;
 
 	/**
-	 * @brief Container indicating which canvas pixels have been visited by previous traces
+	 * @brief The fraction of the canvas that changed in the last video frame
 	 */
-	ofPixels visitedPixels;
+	float changedFraction;
 
 	/**
-	 * @brief Container with the colors of the currently painted pixels
+	 * @brief The number of bad painted pixels in each canvas tile, used to draw the bad painted pixels uniformly
 	 */
-	ofPixels paintedPixels;
+	ofxOilWeightedSampler badPaintedTiles;
 
 	/**
-	 * @brief Container indicating which painted pixels have colors that are similar to the original image
+	 * @brief The sampler used to draw the bad painted pixels in proportion to their color error
 	 */
-	ofPixels similarColorPixels;
+	ofxOilWeightedSampler errorSampler;
 
 	/**
-	 * @brief Container with the indices of pixels that are currently bad painted
+	 * @brief Container used to store the bad painted pixels mask of one row
 	 */
-	vector<unsigned int> badPaintedPixels;
+	vector<unsigned char> rowMask;
 
 	/**
 	 * @brief The total number of pixels that are currently bad painted
@@ -316,11 +669,63 @@ protected:
 	 */
 	bool obtainNewTrace;
 
+	/**
+	 * @brief Indicates if a new trace search was interrupted and should continue in the next update
+	 */
+	bool searchInProgress;
+
+	/**
+	 * @brief The number of consecutive invalid trajectories in the current trace search
+	 */
+	unsigned int invalidTrajectoriesCounter;
+
+	/**
+	 * @brief The number of invalid traces in the current trace search
+	 */
+	unsigned int invalidTracesCounter;
+
+	/**
+	 * @brief The number of candidate traces in the current batch
+	 */
+	unsigned int nBatchCandidates;
+
+	/**
+	 * @brief The index of the next batch candidate to process
+	 */
+	unsigned int nextCandidate;
+
 	/**
 	 * @brief The current trace
 	 */
 	ofxOilTrace trace;
 
+	/**
+	 * @brief The accepted traces that will be painted after the current trace, before the next pixel arrays update
+	 */
+	vector<ofxOilTrace> pendingTraces;
+
+	/**
+	 * @brief The index of the next pending trace to paint
+	 */
+	unsigned int nextPendingTrace;
+
+	/**
+	 * @brief The painted regions of the accepted traces that are not completely painted yet, starting with the current
+	 * trace. The new traces cannot overlap them.
+	 */
+	vector<ofRectangle> traceBatchRegions;
+
+	/**
+	 * @brief The painted regions of the traces painted since the last pixel arrays update. The new traces cannot
+	 * overlap them.
+	 */
+	vector<ofRectangle> paintedRegions;
+
+	/**
+	 * @brief The value of the candidates counter when the first trace of the current batch was accepted
+	 */
+	uint64_t traceBatchStartCandidate;
+
 	/**
 	 * @brief The current trace step
 	 */
@@ -0,0 +1,47 @@
+#include "ofxOilSimulatorStats.h"
+#include "ofMain.h"
+
+chrono::steady_clock::time_point ofxOilPhaseStats::addCall(const chrono::steady_clock::time_point& start) {
+	chrono::steady_clock::time_point now = chrono::steady_clock::now();
+	seconds += chrono::duration<double>(now - start).count();
+	++calls;
+	return now;
+}
+
+ofxOilPhaseStats& ofxOilPhaseStats::operator+=(const ofxOilPhaseStats& phase) {
+	seconds += phase.seconds;
+	calls += phase.calls;
+	return *this;
+}
+
+ofxOilSimulatorStats& ofxOilSimulatorStats::operator+=(const ofxOilSimulatorStats& stats) {
+	updatePixelArrays += stats.updatePixelArrays;
+	search += stats.search;
+	varianceMap += stats.varianceMap;
+	stdevBoundMap += stats.stdevBoundMap;
+	importanceMap += stats.importanceMap;
+	trajectoryGeneration += stats.trajectoryGeneration;
+	visitedTrajectoryCheck += stats.visitedTrajectoryCheck;
+	validTrajectoryCheck += stats.validTrajectoryCheck;
+	colorsCalculation += stats.colorsCalculation;
+	improvementCheck += stats.improvementCheck;
+	painting += stats.painting;
+	accepted += stats.accepted;
+	visitedRejections += stats.visitedRejections;
+	outsideCanvasRejections += stats.outsideCanvasRejections;
+	wellPaintedRejections += stats.wellPaintedRejections;
+	highColorStdevRejections += stats.highColorStdevRejections;
+	batchOverlapRejections += stats.batchOverlapRejections;
+	noImprovementRejections += stats.noImprovementRejections;
+	seedPrefilterRedraws += stats.seedPrefilterRedraws;
+	return *this;
+}
+
+uint64_t ofxOilSimulatorStats::getNCandidates() const {
+	return accepted + getNRejections();
+}
+
+uint64_t ofxOilSimulatorStats::getNRejections() const {
+	return visitedRejections + outsideCanvasRejections + wellPaintedRejections + highColorStdevRejections
+			+ batchOverlapRejections + noImprovementRejections;
+}
@@ -0,0 +1,167 @@
+#pragma once
+
+#include "ofMain.h"
+
+/**
+ * @brief Struct containing the cumulative time and number of calls of a simulation phase
+ *
+ * @author Javier Graciá Carpio
+ */
+struct ofxOilPhaseStats {
+
+	/**
+	 * @brief Adds a new phase call that started at the given time and finishes now
+	 *
+	 * @param start the time when the phase call started
+	 * @return the current time, that can be used as the start time of the next phase
+	 */
+	chrono::steady_clock::time_point addCall(const chrono::steady_clock::time_point& start);
+
+	/**
+	 * @brief Adds the time and calls of another phase
+	 *
+	 * @param phase the phase to add
+	 * @return a reference to this phase
+	 */
+	ofxOilPhaseStats& operator+=(const ofxOilPhaseStats& phase);
+
+	/**
+	 * @brief The cumulative time spent in the phase, in seconds
+	 */
+	double seconds = 0;
+
+	/**
+	 * @brief The number of times the phase was run
+	 */
+	uint64_t calls = 0;
+};
+
+/**
+ * @brief Struct containing the simulator timing and candidate rejection statistics
+ *
+ * The candidate statistics only include the candidate traces that the simulator processed, in the order they were
+ * processed, so they don't depend on the speculative search batch size. Note that when the candidates are evaluated
+ * in parallel, the sum of the candidate phase times can be larger than the search wall time.
+ *
+ * @author Javier Graciá Carpio
+ */
+struct ofxOilSimulatorStats {
+
+	/**
+	 * @brief Adds the statistics of another instance
+	 *
+	 * @param stats the statistics to add
+	 * @return a reference to this instance
+	 */
+	ofxOilSimulatorStats& operator+=(const ofxOilSimulatorStats& stats);
+
+	/**
+	 * @brief Returns the total number of processed candidate traces
+	 *
+	 * @return the total number of processed candidate traces, including the accepted ones
+	 */
+	uint64_t getNCandidates() const;
+
+	/**
+	 * @brief Returns the total number of rejected candidate traces
+	 *
+	 * @return the total number of rejected candidate traces
+	 */
+	uint64_t getNRejections() const;
+
+	/**
+	 * @brief The pixel arrays update phase
+	 */
+	ofxOilPhaseStats updatePixelArrays;
+
+	/**
+	 * @brief The new trace search phase (wall time, including the evaluation of all the candidates)
+	 */
+	ofxOilPhaseStats search;
+
+	/**
+	 * @brief The variance map calculation phase, used by the importance sampling
+	 */
+	ofxOilPhaseStats varianceMap;
+
+	/**
+	 * @brief The standard deviation bound map calculation phase, used to filter the trace starting pixels
+	 */
+	ofxOilPhaseStats stdevBoundMap;
+
+	/**
+	 * @brief The importance map calculation phase, used to draw the trace starting pixels
+	 */
+	ofxOilPhaseStats importanceMap;
+
+	/**
+	 * @brief The candidate trajectory generation phase
+	 */
+	ofxOilPhaseStats trajectoryGeneration;
+
+	/**
+	 * @brief The already visited trajectory check phase
+	 */
+	ofxOilPhaseStats visitedTrajectoryCheck;
+
+	/**
+	 * @brief The valid trajectory check phase
+	 */
+	ofxOilPhaseStats validTrajectoryCheck;
+
+	/**
+	 * @brief The candidate average and bristle colors calculation phase
+	 */
+	ofxOilPhaseStats colorsCalculation;
+
+	/**
+	 * @brief The painting improvement check phase
+	 */
+	ofxOilPhaseStats improvementCheck;
+
+	/**
+	 * @brief The trace painting phase
+	 */
+	ofxOilPhaseStats painting;
+
+	/**
+	 * @brief The number of accepted candidate traces
+	 */
+	uint64_t accepted = 0;
+
+	/**
+	 * @brief The number of candidates rejected because their trajectory falls in an already visited region
+	 */
+	uint64_t visitedRejections = 0;
+
+	/**
+	 * @brief The number of candidates rejected because they fall mostly outside the canvas
+	 */
+	uint64_t outsideCanvasRejections = 0;
+
+	/**
+	 * @brief The number of candidates rejected because they fall in an already well painted region
+	 */
+	uint64_t wellPaintedRejections = 0;
+
+	/**
+	 * @brief The number of candidates rejected because the image colors change too much along their trajectory
+	 */
+	uint64_t highColorStdevRejections = 0;
+
+	/**
+	 * @brief The number of accepted candidates discarded because they overlap a trace in the same trace batch
+	 */
+	uint64_t batchOverlapRejections = 0;
+
+	/**
+	 * @brief The number of candidates rejected because they don't improve the painting enough
+	 */
+	uint64_t noImprovementRejections = 0;
+
+	/**
+	 * @brief The number of trace starting pixels drawn again because the image colors change too much around them.
+	 * They are not candidates, since their trajectories are never created.
+	 */
+	uint64_t seedPrefilterRedraws = 0;
+};
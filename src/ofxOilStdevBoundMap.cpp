@@ -0,0 +1,169 @@
+#include "ofxOilStdevBoundMap.h"
+#include "ofMain.h"
+
+ofxOilStdevBoundMap::ofxOilStdevBoundMap() :
+		width(0), radius(-1), nSamples(0), nBlocksX(0) {
+}
+
+void ofxOilStdevBoundMap::calculate(const ofPixels& pixels, int _radius, unsigned int _nSamples) {
+	// Check that the input makes sense
+	if (pixels.getNumChannels() < 3) {
+		throw invalid_argument("The standard deviation bound map needs pixels with at least three color channels.");
+	}
+
+	width = pixels.getWidth();
+	int height = pixels.getHeight();
+	int nChannels = pixels.getNumChannels();
+	const unsigned char* data = pixels.getData();
+	radius = max(_radius, 0);
+	nSamples = _nSamples;
+	nBlocksX = (width + BLOCK_SIZE - 1) / BLOCK_SIZE;
+	int nBlocksY = (height + BLOCK_SIZE - 1) / BLOCK_SIZE;
+	bounds.assign(size_t(nBlocksX) * nBlocksY, 0);
+
+	// Less than two samples have always a zero standard deviation
+	if (nSamples < 2) {
+		return;
+	}
+
+	// The color histograms of the blocks, stored as cumulative sums over the blocks above and to the left
+	const int histogramSize = 3 * N_LEVELS;
+	int stride = nBlocksX + 1;
+	vector<uint32_t> cumulativeHistograms(size_t(stride) * (nBlocksY + 1) * histogramSize, 0);
+	auto getHistogram = [&cumulativeHistograms, stride, histogramSize](int blockX, int blockY) {
+		return cumulativeHistograms.data() + (size_t(blockY) * stride + blockX) * histogramSize;
+	};
+
+	for (int y = 0; y < height; ++y) {
+		for (int x = 0; x < width; ++x) {
+			uint32_t* histogram = getHistogram(x / BLOCK_SIZE + 1, y / BLOCK_SIZE + 1);
+			const unsigned char* pixel = data + (size_t(y) * width + x) * nChannels;
+
+			for (int c = 0; c < 3; ++c) {
+				++histogram[c * N_LEVELS + pixel[c] / (256 / N_LEVELS)];
+			}
+		}
+	}
+
+	// Add the histograms of the blocks above and to the left
+	for (int blockY = 1; blockY <= nBlocksY; ++blockY) {
+		for (int blockX = 1; blockX <= nBlocksX; ++blockX) {
+			uint32_t* histogram = getHistogram(blockX, blockY);
+			const uint32_t* left = getHistogram(blockX - 1, blockY);
+			const uint32_t* up = getHistogram(blockX, blockY - 1);
+			const uint32_t* diagonal = getHistogram(blockX - 1, blockY - 1);
+
+			for (int i = 0; i < histogramSize; ++i) {
+				histogram[i] += left[i] + up[i] - diagonal[i];
+			}
+		}
+	}
+
+	// The quantized colors are at most half a level away from the real colors, which can hide at most this standard
+	// deviation in the samples
+	float quantizationStdev = 0.5 * (256 / N_LEVELS - 1) * sqrt(nSamples / (nSamples - 1.0));
+
+	// Calculate the bound of each block with the histogram of all the blocks touched by the boxes of its pixels
+	int blockRadius = (radius + BLOCK_SIZE - 1) / BLOCK_SIZE;
+	vector<uint32_t> histogram(histogramSize);
+
+	for (int blockY = 0; blockY < nBlocksY; ++blockY) {
+		int yMin = max(blockY - blockRadius, 0);
+		int yMax = min(blockY + blockRadius + 1, nBlocksY);
+
+		for (int blockX = 0; blockX < nBlocksX; ++blockX) {
+			int xMin = max(blockX - blockRadius, 0);
+			int xMax = min(blockX + blockRadius + 1, nBlocksX);
+			const uint32_t* bottomRight = getHistogram(xMax, yMax);
+			const uint32_t* bottomLeft = getHistogram(xMin, yMax);
+			const uint32_t* topRight = getHistogram(xMax, yMin);
+			const uint32_t* topLeft = getHistogram(xMin, yMin);
+
+			for (int i = 0; i < histogramSize; ++i) {
+				histogram[i] = bottomRight[i] - bottomLeft[i] - topRight[i] + topLeft[i];
+			}
+
+			// The trajectory is rejected if one of the color channels changes too much
+			float bound = 0;
+
+			for (int c = 0; c < 3; ++c) {
+				bound = max(bound, getMinStdev(histogram.data() + c * N_LEVELS, nSamples) - quantizationStdev);
+			}
+
+			bounds[size_t(blockY) * nBlocksX + blockX] = bound;
+		}
+	}
+}
+
+void ofxOilStdevBoundMap::clear() {
+	radius = -1;
+	nSamples = 0;
+	bounds.clear();
+}
+
+bool ofxOilStdevBoundMap::isCalculated() const {
+	return radius >= 0;
+}
+
+int ofxOilStdevBoundMap::getRadius() const {
+	return radius;
+}
+
+unsigned int ofxOilStdevBoundMap::getNSamples() const {
+	return nSamples;
+}
+
+float ofxOilStdevBoundMap::getStdevBound(unsigned int pixel) const {
+	return bounds[size_t(pixel / width / BLOCK_SIZE) * nBlocksX + (pixel % width) / BLOCK_SIZE];
+}
+
+bool ofxOilStdevBoundMap::exceeds(unsigned int pixel, float maxStdev) const {
+	return getStdevBound(pixel) > maxStdev;
+}
+
+float ofxOilStdevBoundMap::getMinStdev(const uint32_t* histogram, unsigned int nSamples) {
+	// The variance of a window of consecutive sorted samples is a concave function of the window position while its
+	// ends stay inside the same levels, so the smallest variance is found in a window that starts or ends with the
+	// first or the last sample of a level
+	const int levelSize = 256 / N_LEVELS;
+	double minVariance = -1;
+
+	for (int direction = 1; direction >= -1; direction -= 2) {
+		for (int i = 0; i < N_LEVELS; ++i) {
+			int firstLevel = direction > 0 ? i : N_LEVELS - 1 - i;
+
+			if (histogram[firstLevel] == 0) {
+				continue;
+			}
+
+			// Take all the samples or only one sample from the first level
+			for (uint64_t nFirstLevelSamples : { uint64_t(histogram[firstLevel]), uint64_t(1) }) {
+				// Take the samples from the consecutive levels until we have enough of them
+				uint64_t nTaken = 0;
+				double sum = 0;
+				double sqSum = 0;
+
+				for (int level = firstLevel; level >= 0 && level < N_LEVELS && nTaken < nSamples;
+						level += direction) {
+					uint64_t nLevelSamples = level == firstLevel ? nFirstLevelSamples : histogram[level];
+					uint64_t n = min<uint64_t>(nLevelSamples, nSamples - nTaken);
+					double value = levelSize * level + 0.5 * (levelSize - 1);
+					nTaken += n;
+					sum += n * value;
+					sqSum += n * value * value;
+				}
+
+				if (nTaken == nSamples) {
+					double variance = max((sqSum - sum * sum / nSamples) / (nSamples - 1), 0.0);
+
+					if (minVariance < 0 || variance < minVariance) {
+						minVariance = variance;
+					}
+				}
+			}
+		}
+	}
+
+	// There is no bound if the histogram has less pixels than samples
+	return minVariance < 0 ? 0 : sqrt(minVariance);
+}
@@ -0,0 +1,127 @@
+#pragma once
+
+#include "ofMain.h"
+
+/**
+ * @brief Class used to calculate a lower bound of the image colors standard deviation along any trace trajectory
+ * starting on each pixel
+ *
+ * A trajectory with a maximum length L samples its colors inside the box of radius L centered on its starting pixel.
+ * The trajectory positions are traceSpeed pixels apart and turn slowly, so they sample different pixels, and the
+ * smallest standard deviation that n samples from the box can have is the one of the n closest values in each color
+ * channel. The bound is calculated with the box color histograms, quantized to 64 levels, and subtracting the
+ * largest standard deviation that the quantization can hide, so a trajectory starting on a pixel whose bound exceeds
+ * the trajectory limit is certain to be rejected. The boxes are extended to cover square blocks of pixels, that share
+ * the same bound, so the map is calculated with the histograms of the blocks.
+ *
+ * @author Javier Graciá Carpio
+ */
+class ofxOilStdevBoundMap {
+public:
+
+	/**
+	 * @brief Constructor
+	 */
+	ofxOilStdevBoundMap();
+
+	/**
+	 * @brief Calculates the lower bound of the color standard deviation of the samples inside the box centered on
+	 * each pixel
+	 *
+	 * @param pixels the image pixels. Only the first three color channels are used.
+	 * @param _radius the box radius in pixels
+	 * @param _nSamples the minimum number of samples. The bound is zero if it's smaller than 2.
+	 */
+	void calculate(const ofPixels& pixels, int _radius, unsigned int _nSamples);
+
+	/**
+	 * @brief Removes the calculated map
+	 */
+	void clear();
+
+	/**
+	 * @brief Checks if the map has been calculated
+	 *
+	 * @return true if the map has been calculated
+	 */
+	bool isCalculated() const;
+
+	/**
+	 * @brief Returns the box radius used to calculate the map
+	 *
+	 * @return the box radius in pixels. It is negative if the map has not been calculated.
+	 */
+	int getRadius() const;
+
+	/**
+	 * @brief Returns the minimum number of samples used to calculate the map
+	 *
+	 * @return the minimum number of samples
+	 */
+	unsigned int getNSamples() const;
+
+	/**
+	 * @brief Returns the color standard deviation lower bound around a pixel
+	 *
+	 * @param pixel the pixel index (y * width + x)
+	 * @return the largest color channel standard deviation lower bound of the samples around the pixel
+	 */
+	float getStdevBound(unsigned int pixel) const;
+
+	/**
+	 * @brief Checks if the color standard deviation of the samples around a pixel is certainly larger than a given
+	 * value
+	 *
+	 * @param pixel the pixel index (y * width + x)
+	 * @param maxStdev the maximum color standard deviation allowed in each color channel
+	 * @return true if the samples around the pixel always have a color standard deviation larger than the maximum
+	 * value
+	 */
+	bool exceeds(unsigned int pixel, float maxStdev) const;
+
+	/**
+	 * @brief The side of the square blocks of pixels that share the same bound
+	 */
+	static const int BLOCK_SIZE = 16;
+
+	/**
+	 * @brief The number of quantized color levels in each color channel histogram
+	 */
+	static const int N_LEVELS = 64;
+
+protected:
+
+	/**
+	 * @brief Returns the smallest standard deviation of a number of samples from a quantized color histogram
+	 *
+	 * @param histogram the number of pixels with each quantized color level
+	 * @param nSamples the number of samples
+	 * @return the smallest standard deviation of the quantized sample colors
+	 */
+	static float getMinStdev(const uint32_t* histogram, unsigned int nSamples);
+
+	/**
+	 * @brief The image width
+	 */
+	int width;
+
+	/**
+	 * @brief The box radius used to calculate the map
+	 */
+	int radius;
+
+	/**
+	 * @brief The minimum number of samples used to calculate the map
+	 */
+	unsigned int nSamples;
+
+	/**
+	 * @brief The number of blocks in the horizontal direction
+	 */
+	int nBlocksX;
+
+	/**
+	 * @brief The color standard deviation lower bound of each block
+	 */
+	vector<float> bounds;
+};
@@ -0,0 +1,227 @@
+#include "ofxOilStrokeLogReader.h"
+#include "ofxOilStrokeLogWriter.h"
+#include "ofxOilMappedFile.h"
+#include "ofxOilTrace.h"
+#include "ofxOilCanvas.h"
+#include "ofxOilScaledCanvas.h"
+#include "ofxOilRandom.h"
+#include "ofxOilConfig.h"
+#include "ofMain.h"
+
+ofxOilStrokeLogReader::ofxOilStrokeLogReader(const string& path, const ofxOilConfig& _config) :
+		config(make_shared<const ofxOilConfig>(_config)) {
+	// Map the file and check its header
+	file.open(path);
+	const unsigned char* start = file.getData();
+	const unsigned char* end = start + file.getSize();
+	const unsigned char* position = start;
+
+	if (file.getSize() < 4 || !equal(position, position + 4, ofxOilStrokeLogWriter::MAGIC)) {
+		throw runtime_error("The file " + path + " is not a stroke log.");
+	}
+
+	position += 4;
+
+	if (readVarint(position, end) != ofxOilStrokeLogWriter::VERSION) {
+		throw runtime_error("The stroke log " + path + " has an unsupported version.");
+	}
+
+	width = readVarint(position, end);
+	height = readVarint(position, end);
+
+	if (end - position < 4) {
+		throw runtime_error("The stroke log " + path + " header is truncated.");
+	}
+
+	backgroundColor.set(position[0], position[1], position[2], position[3]);
+	position += 4;
+
+	// Index the trace records
+	while (position < end) {
+		size_t recordSize = readVarint(position, end);
+
+		if (size_t(end - position) < recordSize) {
+			throw runtime_error("The stroke log " + path + " has a truncated trace record.");
+		}
+
+		recordOffsets.push_back(position - start);
+		position += recordSize;
+	}
+
+	recordOffsets.push_back(position - start);
+}
+
+int ofxOilStrokeLogReader::getWidth() const {
+	return width;
+}
+
+int ofxOilStrokeLogReader::getHeight() const {
+	return height;
+}
+
+const ofColor& ofxOilStrokeLogReader::getBackgroundColor() const {
+	return backgroundColor;
+}
+
+unsigned int ofxOilStrokeLogReader::getNTraces() const {
+	return recordOffsets.size() - 1;
+}
+
+ofxOilTrace ofxOilStrokeLogReader::getTrace(unsigned int index) const {
+	// Check that the input makes sense
+	if (index >= getNTraces()) {
+		throw out_of_range("The trace index is outside the stroke log range.");
+	}
+
+	const unsigned char* position = file.getData() + recordOffsets[index];
+	const unsigned char* end = file.getData() + recordOffsets[index + 1];
+
+	// Decode the trace random number seed and the brush size
+	uint64_t seed = readVarint(position, end);
+	float brushSize = readFloat(position, end);
+
+	// Decode the trajectory positions and alphas
+	unsigned int nSteps = readVarint(position, end);
+	vector<glm::vec2> positions(nSteps);
+	vector<unsigned char> alphas(nSteps);
+	uint32_t x = 0;
+	uint32_t y = 0;
+
+	for (glm::vec2& pos : positions) {
+		x += uint32_t(readSignedVarint(position, end));
+		y += uint32_t(readSignedVarint(position, end));
+		memcpy(&pos.x, &x, 4);
+		memcpy(&pos.y, &y, 4);
+	}
+
+	int alpha = 0;
+
+	for (unsigned char& a : alphas) {
+		alpha += readSignedVarint(position, end);
+		a = alpha;
+	}
+
+	// Create the trace with the same brush that was used to paint it
+	ofxOilTrace trace(positions, alphas, ofxOilRandom(seed), config);
+	trace.setBrushSize(brushSize);
+
+	// Decode the bristle colors
+	unsigned int nBristles = readVarint(position, end);
+
+	if (nBristles != trace.getNBristles()) {
+		throw runtime_error("The stroke log trace doesn't match the brush obtained with the simulation parameters.");
+	}
+
+	ofxOilTrace::ColorPlanes colors;
+	colors.resize(nSteps * nBristles);
+	readColorPlane(position, end, nBristles, colors.red);
+	readColorPlane(position, end, nBristles, colors.green);
+	readColorPlane(position, end, nBristles, colors.blue);
+	fill(colors.alpha.begin(), colors.alpha.end(), 255);
+	trace.setBristleColors(colors);
+
+	return trace;
+}
+
+unsigned int ofxOilStrokeLogReader::getTraceNSteps(unsigned int index) const {
+	// Check that the input makes sense
+	if (index >= getNTraces()) {
+		throw out_of_range("The trace index is outside the stroke log range.");
+	}
+
+	const unsigned char* position = file.getData() + recordOffsets[index];
+	const unsigned char* end = file.getData() + recordOffsets[index + 1];
+
+	// Skip the random number seed and the brush size
+	readVarint(position, end);
+	readFloat(position, end);
+
+	return readVarint(position, end);
+}
+
+void ofxOilStrokeLogReader::paint(ofxOilCanvas& canvas, unsigned int firstTrace, unsigned int lastTrace) const {
+	lastTrace = min(lastTrace, getNTraces());
+	canvas.begin();
+
+	for (unsigned int i = firstTrace; i < lastTrace; ++i) {
+		getTrace(i).paint(canvas);
+	}
+
+	canvas.end();
+}
+
+ofPixels ofxOilStrokeLogReader::render(float scale) const {
+	ofxOilScaledCanvas canvas(ofxOilCanvas::create(OFX_OIL_CANVAS_PIXELS), scale);
+	canvas.allocate(width, height, backgroundColor);
+	paint(canvas);
+	canvas.updatePixels();
+	return canvas.getPixels();
+}
+
+uint64_t ofxOilStrokeLogReader::readVarint(const unsigned char*& position, const unsigned char* end) {
+	uint64_t value = 0;
+
+	for (unsigned int shift = 0; shift < 64; shift += 7) {
+		if (position == end) {
+			throw runtime_error("The stroke log data is truncated.");
+		}
+
+		unsigned char byte = *position++;
+		value |= uint64_t(byte & 0x7F) << shift;
+
+		if ((byte & 0x80) == 0) {
+			return value;
+		}
+	}
+
+	throw runtime_error("The stroke log contains an invalid variable length integer.");
+}
+
+int64_t ofxOilStrokeLogReader::readSignedVarint(const unsigned char*& position, const unsigned char* end) {
+	uint64_t value = readVarint(position, end);
+	return int64_t(value >> 1) ^ -int64_t(value & 1);
+}
+
+float ofxOilStrokeLogReader::readFloat(const unsigned char*& position, const unsigned char* end) {
+	if (end - position < 4) {
+		throw runtime_error("The stroke log data is truncated.");
+	}
+
+	uint32_t bits = 0;
+
+	for (unsigned int i = 0; i < 4; ++i) {
+		bits |= uint32_t(*position++) << (8 * i);
+	}
+
+	float value;
+	memcpy(&value, &bits, 4);
+	return value;
+}
+
+void ofxOilStrokeLogReader::readColorPlane(const unsigned char*& position, const unsigned char* end,
+		unsigned int nBristles, vector<unsigned char>& colors) {
+	size_t index = 0;
+	size_t nColors = colors.size();
+
+	while (true) {
+		// Copy the previous step colors for the run of unchanged colors
+		uint64_t zerosCounter = readVarint(position, end);
+
+		if (zerosCounter > nColors - index) {
+			throw runtime_error("The stroke log contains invalid bristle colors.");
+		}
+
+		for (size_t runEnd = index + zerosCounter; index < runEnd; ++index) {
+			colors[index] = index < nBristles ? 0 : colors[index - nBristles];
+		}
+
+		if (index == nColors) {
+			break;
+		}
+
+		// Add the difference to the previous step color
+		int previous = index < nBristles ? 0 : colors[index - nBristles];
+		colors[index] = previous + readSignedVarint(position, end);
+		++index;
+	}
+}
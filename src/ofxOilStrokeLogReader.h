@@ -0,0 +1,164 @@
+#pragma once
+
+#include "ofMain.h"
+#include "ofxOilMappedFile.h"
+#include "ofxOilTrace.h"
+#include "ofxOilCanvas.h"
+#include "ofxOilConfig.h"
+
+/**
+ * @brief Class used to read and replay a stroke log written by ofxOilStrokeLogWriter
+ *
+ * The log file is mapped in memory and the position of each trace record is indexed when the log is opened, so any
+ * trace can be decoded without decoding the previous ones. The replayed traces are painted with their recorded bristle
+ * colors, so the candidate search and the color calculations are not repeated. The simulation parameters used to
+ * replay the log should coincide with the ones used to record it.
+ *
+ * @author Javier Graciá Carpio
+ */
+class ofxOilStrokeLogReader {
+public:
+
+	/**
+	 * @brief Constructor. Maps the log file in memory and indexes its trace records.
+	 *
+	 * @param path the log file path
+	 * @param _config the simulation parameters used to replay the traces
+	 */
+	ofxOilStrokeLogReader(const string& path, const ofxOilConfig& _config = ofxOilConfig());
+
+	/**
+	 * @brief Returns the recorded canvas width
+	 *
+	 * @return the recorded canvas width
+	 */
+	int getWidth() const;
+
+	/**
+	 * @brief Returns the recorded canvas height
+	 *
+	 * @return the recorded canvas height
+	 */
+	int getHeight() const;
+
+	/**
+	 * @brief Returns the recorded canvas background color
+	 *
+	 * @return the recorded canvas background color
+	 */
+	const ofColor& getBackgroundColor() const;
+
+	/**
+	 * @brief Returns the number of traces in the log
+	 *
+	 * @return the number of traces in the log
+	 */
+	unsigned int getNTraces() const;
+
+	/**
+	 * @brief Decodes one of the log traces
+	 *
+	 * @param index the trace index
+	 * @return the decoded trace, ready to be painted
+	 */
+	ofxOilTrace getTrace(unsigned int index) const;
+
+	/**
+	 * @brief Returns the number of trajectory steps of one of the log traces, without decoding the whole trace
+	 *
+	 * @param index the trace index
+	 * @return the number of trajectory steps of the trace
+	 */
+	unsigned int getTraceNSteps(unsigned int index) const;
+
+	/**
+	 * @brief Paints a range of the log traces on a canvas
+	 *
+	 * @param canvas the canvas where the traces should be painted
+	 * @param firstTrace the index of the first trace to paint
+	 * @param lastTrace the index after the last trace to paint. It is limited to the number of traces in the log.
+	 */
+	void paint(ofxOilCanvas& canvas, unsigned int firstTrace = 0,
+			unsigned int lastTrace = numeric_limits<unsigned int>::max()) const;
+
+	/**
+	 * @brief Replays all the log traces on a clean canvas
+	 *
+	 * The traces can be rasterized at a higher resolution than the one used to record them, for the cost of the
+	 * painting alone.
+	 *
+	 * @param scale the scale factor between the recorded canvas and the returned pixels
+	 * @return the canvas pixels after painting all the traces
+	 */
+	ofPixels render(float scale = 1.0) const;
+
+protected:
+
+	/**
+	 * @brief Reads an unsigned integer encoded with a variable number of bytes
+	 *
+	 * @param position the reading position. It is moved after the integer.
+	 * @param end the end of the readable data
+	 * @return the integer value
+	 */
+	static uint64_t readVarint(const unsigned char*& position, const unsigned char* end);
+
+	/**
+	 * @brief Reads a signed integer encoded with a variable number of bytes
+	 *
+	 * @param position the reading position. It is moved after the integer.
+	 * @param end the end of the readable data
+	 * @return the integer value
+	 */
+	static int64_t readSignedVarint(const unsigned char*& position, const unsigned char* end);
+
+	/**
+	 * @brief Reads a float encoded with four bytes in little-endian order
+	 *
+	 * @param position the reading position. It is moved after the float.
+	 * @param end the end of the readable data
+	 * @return the float value
+	 */
+	static float readFloat(const unsigned char*& position, const unsigned char* end);
+
+	/**
+	 * @brief Reads the bristle colors of one color channel
+	 *
+	 * @param position the reading position. It is moved after the color channel data.
+	 * @param end the end of the readable data
+	 * @param nBristles the number of bristles
+	 * @param colors the container where the color channel values will be saved. It should have the correct size.
+	 */
+	static void readColorPlane(const unsigned char*& position, const unsigned char* end, unsigned int nBristles,
+			vector<unsigned char>& colors);
+
+	/**
+	 * @brief The simulation parameters
+	 */
+	shared_ptr<const ofxOilConfig> config;
+
+	/**
+	 * @brief The mapped log file
+	 */
+	ofxOilMappedFile file;
+
+	/**
+	 * @brief The recorded canvas width
+	 */
+	int width;
+
+	/**
+	 * @brief The recorded canvas height
+	 */
+	int height;
+
+	/**
+	 * @brief The recorded canvas background color
+	 */
+	ofColor backgroundColor;
+
+	/**
+	 * @brief The offsets of the trace records in the file, followed by the end of the last record
+	 */
+	vector<size_t> recordOffsets;
+};
@@ -0,0 +1,142 @@
+#include "ofxOilStrokeLogWriter.h"
+#include "ofxOilTrace.h"
+#include "ofMain.h"
+
+const char ofxOilStrokeLogWriter::MAGIC[4] = {'O', 'I', 'L', 'S'};
+
+ofxOilStrokeLogWriter::ofxOilStrokeLogWriter(const string& path, int width, int height,
+		const ofColor& backgroundColor) :
+		file(ofToDataPath(path, true), ios::binary | ios::trunc) {
+	// Check that the file could be created
+	if (!file) {
+		throw runtime_error("The stroke log file " + path + " could not be created.");
+	}
+
+	// Write the header
+	record.assign(MAGIC, MAGIC + 4);
+	writeVarint(record, VERSION);
+	writeVarint(record, width);
+	writeVarint(record, height);
+	record.insert(record.end(), {backgroundColor.r, backgroundColor.g, backgroundColor.b, backgroundColor.a});
+	file.write(reinterpret_cast<const char*>(record.data()), record.size());
+	nTraces = 0;
+	size = record.size();
+}
+
+void ofxOilStrokeLogWriter::addTrace(const ofxOilTrace& trace) {
+	// Check that the bristle colors have been calculated before running this method
+	const ofxOilTrace::ColorPlanes& colors = trace.getBristleColors();
+
+	if (colors.empty()) {
+		throw logic_error("Please, calculate the trace bristle colors before adding it to the stroke log.");
+	}
+
+	// Encode the trace random number seed and the brush size
+	record.clear();
+	writeVarint(record, trace.getSeed());
+	writeFloat(record, trace.getBrushSize());
+
+	// Encode the trajectory positions as the difference between the consecutive float bit patterns
+	const vector<glm::vec2>& positions = trace.getTrajectoryPositions();
+	const vector<unsigned char>& alphas = trace.getTrajectoryAphas();
+	unsigned int nSteps = trace.getNSteps();
+	writeVarint(record, nSteps);
+	uint32_t previousX = 0;
+	uint32_t previousY = 0;
+
+	for (const glm::vec2& position : positions) {
+		uint32_t x;
+		uint32_t y;
+		memcpy(&x, &position.x, 4);
+		memcpy(&y, &position.y, 4);
+		writeSignedVarint(record, int32_t(x - previousX));
+		writeSignedVarint(record, int32_t(y - previousY));
+		previousX = x;
+		previousY = y;
+	}
+
+	// Encode the trajectory alphas as the difference with the previous alpha
+	int previousAlpha = 0;
+
+	for (unsigned char alpha : alphas) {
+		writeSignedVarint(record, alpha - previousAlpha);
+		previousAlpha = alpha;
+	}
+
+	// Encode the bristle colors
+	unsigned int nBristles = trace.getNBristles();
+	writeVarint(record, nBristles);
+	writeColorPlane(record, colors.red, nBristles);
+	writeColorPlane(record, colors.green, nBristles);
+	writeColorPlane(record, colors.blue, nBristles);
+
+	// Write the record preceded by its size, so the records can be skipped without decoding them
+	recordSize.clear();
+	writeVarint(recordSize, record.size());
+	file.write(reinterpret_cast<const char*>(recordSize.data()), recordSize.size());
+	file.write(reinterpret_cast<const char*>(record.data()), record.size());
+	size += recordSize.size() + record.size();
+	++nTraces;
+
+	if (!file) {
+		throw runtime_error("The trace could not be written to the stroke log file.");
+	}
+}
+
+void ofxOilStrokeLogWriter::flush() {
+	file.flush();
+}
+
+unsigned int ofxOilStrokeLogWriter::getNTraces() const {
+	return nTraces;
+}
+
+size_t ofxOilStrokeLogWriter::getSize() const {
+	return size;
+}
+
+void ofxOilStrokeLogWriter::writeVarint(vector<unsigned char>& buffer, uint64_t value) {
+	// Write seven bits per byte, using the highest bit to indicate that more bytes follow
+	while (value >= 0x80) {
+		buffer.push_back((value & 0x7F) | 0x80);
+		value >>= 7;
+	}
+
+	buffer.push_back(value);
+}
+
+void ofxOilStrokeLogWriter::writeSignedVarint(vector<unsigned char>& buffer, int64_t value) {
+	// Use the zigzag encoding, so small negative values also use few bytes
+	writeVarint(buffer, (uint64_t(value) << 1) ^ uint64_t(value >> 63));
+}
+
+void ofxOilStrokeLogWriter::writeFloat(vector<unsigned char>& buffer, float value) {
+	uint32_t bits;
+	memcpy(&bits, &value, 4);
+
+	for (unsigned int i = 0; i < 4; ++i) {
+		buffer.push_back((bits >> (8 * i)) & 0xFF);
+	}
+}
+
+void ofxOilStrokeLogWriter::writeColorPlane(vector<unsigned char>& buffer, const vector<unsigned char>& colors,
+		unsigned int nBristles) {
+	uint64_t zerosCounter = 0;
+
+	for (size_t index = 0, nColors = colors.size(); index < nColors; ++index) {
+		// Calculate the difference with the same bristle color in the previous step
+		int difference = index < nBristles ? colors[index] : colors[index] - colors[index - nBristles];
+
+		if (difference == 0) {
+			++zerosCounter;
+		} else {
+			// Write the number of zeros before the difference, followed by the difference
+			writeVarint(buffer, zerosCounter);
+			writeSignedVarint(buffer, difference);
+			zerosCounter = 0;
+		}
+	}
+
+	// Write the remaining zeros
+	writeVarint(buffer, zerosCounter);
+}
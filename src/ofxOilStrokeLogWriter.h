@@ -0,0 +1,131 @@
+#pragma once
+
+#include "ofMain.h"
+#include "ofxOilTrace.h"
+
+/**
+ * @brief Class used to record the painted traces in a compact binary stroke log
+ *
+ * The log starts with a header containing the canvas dimensions and background color, followed by one record for
+ * each trace. A record contains the trace random number seed, its brush size, its trajectory positions and alphas, and
+ * its bristle colors. The positions, alphas and colors are delta encoded and written as variable length integers,
+ * and the runs of unchanged bristle colors are run-length encoded. The positions are stored exactly, so the replayed
+ * traces are identical to the recorded ones.
+ *
+ * @author Javier Graciá Carpio
+ */
+class ofxOilStrokeLogWriter {
+public:
+
+	/**
+	 * @brief The stroke log format identifier, written at the beginning of the file
+	 */
+	static const char MAGIC[4];
+
+	/**
+	 * @brief The stroke log format version
+	 */
+	static const unsigned int VERSION = 1;
+
+	/**
+	 * @brief Constructor. Creates the log file and writes its header.
+	 *
+	 * @param path the log file path
+	 * @param width the canvas width
+	 * @param height the canvas height
+	 * @param backgroundColor the canvas background color
+	 */
+	ofxOilStrokeLogWriter(const string& path, int width, int height, const ofColor& backgroundColor);
+
+	/**
+	 * @brief Adds a trace to the log
+	 *
+	 * Note that the trace bristle colors should have been calculated before.
+	 *
+	 * @param trace the trace to add
+	 */
+	void addTrace(const ofxOilTrace& trace);
+
+	/**
+	 * @brief Writes the buffered records to the file
+	 */
+	void flush();
+
+	/**
+	 * @brief Returns the number of traces added to the log
+	 *
+	 * @return the number of traces added to the log
+	 */
+	unsigned int getNTraces() const;
+
+	/**
+	 * @brief Returns the number of bytes written to the log, including the buffered records
+	 *
+	 * @return the number of bytes written to the log
+	 */
+	size_t getSize() const;
+
+protected:
+
+	/**
+	 * @brief Appends an unsigned integer to a buffer, using a variable number of bytes
+	 *
+	 * @param buffer the buffer
+	 * @param value the value to append
+	 */
+	static void writeVarint(vector<unsigned char>& buffer, uint64_t value);
+
+	/**
+	 * @brief Appends a signed integer to a buffer, using a variable number of bytes
+	 *
+	 * @param buffer the buffer
+	 * @param value the value to append
+	 */
+	static void writeSignedVarint(vector<unsigned char>& buffer, int64_t value);
+
+	/**
+	 * @brief Appends a float to a buffer, using four bytes in little-endian order
+	 *
+	 * @param buffer the buffer
+	 * @param value the value to append
+	 */
+	static void writeFloat(vector<unsigned char>& buffer, float value);
+
+	/**
+	 * @brief Appends the bristle colors of one color channel to a buffer
+	 *
+	 * Each color is encoded as the difference with the same bristle color in the previous step. The runs of zero
+	 * differences are stored as their length.
+	 *
+	 * @param buffer the buffer
+	 * @param colors the color channel values, one for each trajectory step and bristle
+	 * @param nBristles the number of bristles
+	 */
+	static void writeColorPlane(vector<unsigned char>& buffer, const vector<unsigned char>& colors,
+			unsigned int nBristles);
+
+	/**
+	 * @brief The log output file
+	 */
+	ofstream file;
+
+	/**
+	 * @brief The record being encoded
+	 */
+	vector<unsigned char> record;
+
+	/**
+	 * @brief The encoded size of the record being written
+	 */
+	vector<unsigned char> recordSize;
+
+	/**
+	 * @brief The number of traces added to the log
+	 */
+	unsigned int nTraces;
+
+	/**
+	 * @brief The number of bytes written to the log
+	 */
+	size_t size;
+};
@@ -0,0 +1,125 @@
+#include "ofxOilStrokeTimeline.h"
+#include "ofxOilStrokeLogReader.h"
+#include "ofxOilScaledCanvas.h"
+#include "ofxOilTrace.h"
+#include "ofxOilCanvas.h"
+#include "ofMain.h"
+
+ofxOilStrokeTimeline::ofxOilStrokeTimeline(const ofxOilStrokeLogReader& _reader, unsigned int _keyframeInterval,
+		float scale, ofxOilCanvasType canvasType) :
+		reader(_reader), keyframeInterval(max(_keyframeInterval, 1u)),
+		canvas(new ofxOilScaledCanvas(ofxOilCanvas::create(canvasType), scale)) {
+	// Calculate the number of steps painted before each trace
+	unsigned int nTraces = reader.getNTraces();
+	cumulativeSteps.assign(nTraces + 1, 0);
+
+	for (unsigned int i = 0; i < nTraces; ++i) {
+		cumulativeSteps[i + 1] = cumulativeSteps[i] + reader.getTraceNSteps(i);
+	}
+
+	// Replay all the traces, saving the canvas pixels every keyframe interval
+	canvas->allocate(reader.getWidth(), reader.getHeight(), reader.getBackgroundColor());
+	canvas->updatePixels();
+	keyframes.push_back(canvas->getPixels());
+
+	for (unsigned int i = 0; i < nTraces; i += keyframeInterval) {
+		reader.paint(*canvas, i, i + keyframeInterval);
+
+		if (i + keyframeInterval < nTraces) {
+			canvas->updatePixels();
+			keyframes.push_back(canvas->getPixels());
+		}
+	}
+
+	// The canvas shows now the finished painting
+	currentTrace = nTraces;
+	currentTraceStep = 0;
+}
+
+void ofxOilStrokeTimeline::seekToTrace(unsigned int nTraces) {
+	seek(min(nTraces, getNTraces()), 0);
+}
+
+void ofxOilStrokeTimeline::seekToStep(uint64_t nSteps) {
+	// Find the trace that contains the given step
+	if (nSteps >= getNSteps()) {
+		seek(getNTraces(), 0);
+	} else {
+		unsigned int traceIndex = upper_bound(cumulativeSteps.begin(), cumulativeSteps.end(), nSteps)
+				- cumulativeSteps.begin() - 1;
+		seek(traceIndex, nSteps - cumulativeSteps[traceIndex]);
+	}
+}
+
+void ofxOilStrokeTimeline::seekToTime(float seconds, float stepsPerSecond) {
+	seekToStep(max(0.0, floor(double(seconds) * stepsPerSecond)));
+}
+
+const ofPixels& ofxOilStrokeTimeline::getPixels() {
+	canvas->updatePixels();
+	return canvas->getPixels();
+}
+
+void ofxOilStrokeTimeline::draw(float x, float y) const {
+	canvas->draw(x, y);
+}
+
+unsigned int ofxOilStrokeTimeline::getNTraces() const {
+	return cumulativeSteps.size() - 1;
+}
+
+uint64_t ofxOilStrokeTimeline::getNSteps() const {
+	return cumulativeSteps.back();
+}
+
+unsigned int ofxOilStrokeTimeline::getCurrentTrace() const {
+	return currentTrace;
+}
+
+uint64_t ofxOilStrokeTimeline::getCurrentStep() const {
+	return cumulativeSteps[currentTrace] + currentTraceStep;
+}
+
+void ofxOilStrokeTimeline::seek(unsigned int traceIndex, unsigned int traceStep) {
+	// Restore the closest previous keyframe if we need to move backwards or it's closer to the target
+	unsigned int keyframe = min<size_t>(traceIndex / keyframeInterval, keyframes.size() - 1);
+	bool isForward = traceIndex > currentTrace || (traceIndex == currentTrace && traceStep >= currentTraceStep);
+
+	if (!isForward || keyframe * keyframeInterval > currentTrace) {
+		canvas->setPixels(keyframes[keyframe]);
+		currentTrace = keyframe * keyframeInterval;
+		currentTraceStep = 0;
+	}
+
+	canvas->begin();
+
+	// Finish the partially painted trace if the target is after it
+	if (currentTraceStep > 0 && traceIndex > currentTrace) {
+		for (unsigned int step = currentTraceStep, nSteps = partialTrace.getNSteps(); step < nSteps; ++step) {
+			partialTrace.paintStep(step, *canvas);
+		}
+
+		++currentTrace;
+		currentTraceStep = 0;
+	}
+
+	// Paint the complete traces
+	for (; currentTrace < traceIndex; ++currentTrace) {
+		reader.getTrace(currentTrace).paint(*canvas);
+	}
+
+	// Paint the steps of the partially painted trace
+	if (traceStep > currentTraceStep) {
+		if (currentTraceStep == 0) {
+			partialTrace = reader.getTrace(currentTrace);
+		}
+
+		for (unsigned int step = currentTraceStep; step < traceStep; ++step) {
+			partialTrace.paintStep(step, *canvas);
+		}
+
+		currentTraceStep = traceStep;
+	}
+
+	canvas->end();
+}
@@ -0,0 +1,146 @@
+#pragma once
+
+#include "ofMain.h"
+#include "ofxOilStrokeLogReader.h"
+#include "ofxOilTrace.h"
+#include "ofxOilCanvas.h"
+
+/**
+ * @brief Class used to show the state of a recorded painting at any point of its stroke log
+ *
+ * The canvas is saved as a keyframe every fixed number of traces when the timeline is created. Seeking to a given
+ * trace or trajectory step restores the previous keyframe and paints only the traces after it, so the cost of a seek
+ * is proportional to the keyframe interval and not to the total number of traces. Seeking forward from the current
+ * position paints only the missing traces, so playing the painting animation step by step is also cheap.
+ *
+ * @author Javier Graciá Carpio
+ */
+class ofxOilStrokeTimeline {
+public:
+
+	/**
+	 * @brief Constructor. Replays the whole stroke log once to calculate the keyframes.
+	 *
+	 * @param _reader the stroke log reader. It should exist as long as the timeline is used.
+	 * @param _keyframeInterval the number of traces between two consecutive keyframes
+	 * @param scale the scale factor between the recorded canvas and the timeline canvas
+	 * @param canvasType the canvas type
+	 */
+	ofxOilStrokeTimeline(const ofxOilStrokeLogReader& _reader, unsigned int _keyframeInterval = 500, float scale = 1.0,
+			ofxOilCanvasType canvasType = OFX_OIL_CANVAS_PIXELS);
+
+	/**
+	 * @brief Moves the timeline to the moment where a given number of traces have been painted
+	 *
+	 * @param nTraces the number of painted traces
+	 */
+	void seekToTrace(unsigned int nTraces);
+
+	/**
+	 * @brief Moves the timeline to the moment where a given number of trajectory steps have been painted
+	 *
+	 * @param nSteps the number of painted trajectory steps, counting the steps of all the traces
+	 */
+	void seekToStep(uint64_t nSteps);
+
+	/**
+	 * @brief Moves the timeline to a given time of the painting animation
+	 *
+	 * @param seconds the animation time in seconds
+	 * @param stepsPerSecond the number of trajectory steps painted per second in the animation
+	 */
+	void seekToTime(float seconds, float stepsPerSecond);
+
+	/**
+	 * @brief Returns the canvas pixels at the current timeline position
+	 *
+	 * @return the canvas pixels at the current timeline position
+	 */
+	const ofPixels& getPixels();
+
+	/**
+	 * @brief Draws the canvas on the screen
+	 *
+	 * @param x the screen x position
+	 * @param y the screen y position
+	 */
+	void draw(float x, float y) const;
+
+	/**
+	 * @brief Returns the number of traces in the timeline
+	 *
+	 * @return the number of traces in the timeline
+	 */
+	unsigned int getNTraces() const;
+
+	/**
+	 * @brief Returns the total number of trajectory steps in the timeline
+	 *
+	 * @return the total number of trajectory steps
+	 */
+	uint64_t getNSteps() const;
+
+	/**
+	 * @brief Returns the number of completely painted traces at the current timeline position
+	 *
+	 * @return the number of completely painted traces
+	 */
+	unsigned int getCurrentTrace() const;
+
+	/**
+	 * @brief Returns the number of painted trajectory steps at the current timeline position
+	 *
+	 * @return the number of painted trajectory steps
+	 */
+	uint64_t getCurrentStep() const;
+
+protected:
+
+	/**
+	 * @brief Moves the timeline to a given trace and trajectory step
+	 *
+	 * @param traceIndex the number of completely painted traces
+	 * @param traceStep the number of painted steps of the next trace
+	 */
+	void seek(unsigned int traceIndex, unsigned int traceStep);
+
+	/**
+	 * @brief The stroke log reader
+	 */
+	const ofxOilStrokeLogReader& reader;
+
+	/**
+	 * @brief The number of traces between two consecutive keyframes
+	 */
+	unsigned int keyframeInterval;
+
+	/**
+	 * @brief The canvas pixels every keyframe interval, starting with the clean canvas
+	 */
+	vector<ofPixels> keyframes;
+
+	/**
+	 * @brief The total number of trajectory steps painted before each trace, followed by the total number of steps
+	 */
+	vector<uint64_t> cumulativeSteps;
+
+	/**
+	 * @brief The canvas showing the current timeline position
+	 */
+	unique_ptr<ofxOilCanvas> canvas;
+
+	/**
+	 * @brief The trace that is partially painted at the current timeline position
+	 */
+	ofxOilTrace partialTrace;
+
+	/**
+	 * @brief The number of completely painted traces at the current timeline position
+	 */
+	unsigned int currentTrace;
+
+	/**
+	 * @brief The number of painted steps of the partially painted trace
+	 */
+	unsigned int currentTraceStep;
+};
@@ -0,0 +1,106 @@
+#include "ofxOilThreadPool.h"
+#include "ofMain.h"
+
+ofxOilThreadPool::ofxOilThreadPool(unsigned int nThreads) {
+	// Use the number of hardware threads if necessary
+	if (nThreads == 0) {
+		nThreads = max(1u, thread::hardware_concurrency());
+	}
+
+	// Initialize the job variables
+	jobFunction = nullptr;
+	jobSize = 0;
+	jobCounter = 0;
+	nActiveWorkers = 0;
+	nextIndex = 0;
+	stopWorkers = false;
+
+	// Start the workers. The calling thread is also used to run the loop iterations.
+	for (unsigned int i = 1; i < nThreads; ++i) {
+		workers.emplace_back(&ofxOilThreadPool::workerLoop, this);
+	}
+}
+
+ofxOilThreadPool::~ofxOilThreadPool() {
+	// Tell the workers to stop and wait until they finish
+	{
+		lock_guard<mutex> lock(jobMutex);
+		stopWorkers = true;
+	}
+
+	jobAvailable.notify_all();
+
+	for (thread& worker : workers) {
+		worker.join();
+	}
+}
+
+void ofxOilThreadPool::parallelFor(unsigned int n, const function<void(unsigned int)>& func) {
+	// Run the loop in the calling thread if there are no workers or only one iteration
+	if (workers.size() == 0 || n <= 1) {
+		for (unsigned int i = 0; i < n; ++i) {
+			func(i);
+		}
+
+		return;
+	}
+
+	// Publish the new job
+	{
+		lock_guard<mutex> lock(jobMutex);
+		jobFunction = &func;
+		jobSize = n;
+		nextIndex = 0;
+		nActiveWorkers = workers.size();
+		++jobCounter;
+	}
+
+	jobAvailable.notify_all();
+
+	// Run some of the loop iterations in the calling thread
+	runJob(func, n);
+
+	// Wait until all the workers finished the job
+	unique_lock<mutex> lock(jobMutex);
+	jobFinished.wait(lock, [this] {return nActiveWorkers == 0;});
+	jobFunction = nullptr;
+}
+
+unsigned int ofxOilThreadPool::getNThreads() const {
+	return workers.size() + 1;
+}
+
+void ofxOilThreadPool::workerLoop() {
+	unsigned int lastJob = 0;
+
+	while (true) {
+		// Wait until there is a new job or the workers should stop
+		unique_lock<mutex> lock(jobMutex);
+		jobAvailable.wait(lock, [this, lastJob] {return stopWorkers || jobCounter != lastJob;});
+
+		if (stopWorkers) {
+			return;
+		}
+
+		lastJob = jobCounter;
+		const function<void(unsigned int)>& func = *jobFunction;
+		unsigned int n = jobSize;
+		lock.unlock();
+
+		// Run the job loop iterations
+		runJob(func, n);
+
+		// Tell the calling thread that this worker finished the job
+		lock.lock();
+
+		if (--nActiveWorkers == 0) {
+			jobFinished.notify_all();
+		}
+	}
+}
+
+void ofxOilThreadPool::runJob(const function<void(unsigned int)>& func, unsigned int n) {
+	for (unsigned int i = nextIndex++; i < n; i = nextIndex++) {
+		func(i);
+	}
+}
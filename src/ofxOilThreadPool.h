@@ -0,0 +1,108 @@
+#pragma once
+
+#include "ofMain.h"
+
+/**
+ * @brief Simple pool of worker threads used to run loop iterations in parallel
+ *
+ * @author Javier Graciá Carpio
+ */
+class ofxOilThreadPool {
+public:
+
+	/**
+	 * @brief Constructor
+	 *
+	 * @param nThreads the total number of threads that will run the loop iterations, including the calling thread. If
+	 * zero, the number of hardware threads will be used.
+	 */
+	ofxOilThreadPool(unsigned int nThreads = 0);
+
+	/**
+	 * @brief Destructor. Stops all the worker threads.
+	 */
+	~ofxOilThreadPool();
+
+	/**
+	 * @brief Runs a function for each index in the range [0, n) using all the pool threads
+	 *
+	 * The calling thread also runs iterations and the method only returns when all of them are finished. The function
+	 * should not call parallelFor on the same pool.
+	 *
+	 * @param n the number of loop iterations
+	 * @param func the function to run for each loop index
+	 */
+	void parallelFor(unsigned int n, const function<void(unsigned int)>& func);
+
+	/**
+	 * @brief Returns the total number of threads used to run the loop iterations
+	 *
+	 * @return the total number of threads, including the calling thread
+	 */
+	unsigned int getNThreads() const;
+
+protected:
+
+	/**
+	 * @brief The function run by each worker thread
+	 */
+	void workerLoop();
+
+	/**
+	 * @brief Runs the current job loop iterations until there are no more iterations left
+	 *
+	 * @param func the job function
+	 * @param n the job number of loop iterations
+	 */
+	void runJob(const function<void(unsigned int)>& func, unsigned int n);
+
+	/**
+	 * @brief The worker threads
+	 */
+	vector<thread> workers;
+
+	/**
+	 * @brief The mutex protecting the job variables
+	 */
+	mutex jobMutex;
+
+	/**
+	 * @brief Used to notify the workers that a new job is available
+	 */
+	condition_variable jobAvailable;
+
+	/**
+	 * @brief Used to notify the calling thread that all the workers finished the current job
+	 */
+	condition_variable jobFinished;
+
+	/**
+	 * @brief The current job function
+	 */
+	const function<void(unsigned int)>* jobFunction;
+
+	/**
+	 * @brief The current job number of loop iterations
+	 */
+	unsigned int jobSize;
+
+	/**
+	 * @brief Counts the number of jobs started by the pool
+	 */
+	unsigned int jobCounter;
+
+	/**
+	 * @brief The number of workers that didn't finish the current job yet
+	 */
+	unsigned int nActiveWorkers;
+
+	/**
+	 * @brief The next loop index to run
+	 */
+	atomic<unsigned int> nextIndex;
+
+	/**
+	 * @brief Indicates if the workers should stop
+	 */
+	bool stopWorkers;
+};
@@ -0,0 +1,299 @@
+#include "ofxOilTiledPixels.h"
+#include "ofMain.h"
+
+#ifdef TARGET_WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+ofxOilTiledPixels::ofxOilTiledPixels() {
+	width = 0;
+	height = 0;
+	nChannels = 0;
+	tileSize = 0;
+	maxResidentTiles = 0;
+	nTilesX = 0;
+	tileBytes = 0;
+	tileStride = 0;
+#ifdef TARGET_WIN32
+	fileHandle = nullptr;
+	mappingHandle = nullptr;
+#else
+	fileDescriptor = -1;
+#endif
+}
+
+ofxOilTiledPixels::~ofxOilTiledPixels() {
+	close();
+}
+
+void ofxOilTiledPixels::allocate(int _width, int _height, size_t _nChannels, const ofColor& _fillColor,
+		const string& _path, unsigned int _tileSize, unsigned int _maxResidentTiles) {
+	// Check that the input makes sense
+	if (_width <= 0 || _height <= 0) {
+		throw invalid_argument("The tiled pixels dimensions should be positive.");
+	} else if (_nChannels != 1 && _nChannels != 3 && _nChannels != 4) {
+		throw invalid_argument("The tiled pixels should have 1, 3 or 4 color channels.");
+	} else if (_tileSize == 0) {
+		throw invalid_argument("The tile size should be positive.");
+	}
+
+	// Close the previous tiles if necessary
+	close();
+	width = _width;
+	height = _height;
+	nChannels = _nChannels;
+	fillColor = _fillColor;
+	path = _path;
+	tileSize = _tileSize;
+	maxResidentTiles = max(_maxResidentTiles, 1u);
+	nTilesX = (width + tileSize - 1) / tileSize;
+	unsigned int nTiles = nTilesX * ((height + tileSize - 1) / tileSize);
+
+	// The tiles are mapped at offsets that are multiples of 64KB, the allocation granularity on Windows
+	tileBytes = size_t(tileSize) * tileSize * nChannels;
+	tileStride = ((tileBytes + 65535) / 65536) * 65536;
+	tiles.assign(nTiles, nullptr);
+	initializedTiles.assign(nTiles, false);
+	residentPositions.resize(nTiles);
+
+	if (path.empty()) {
+		memoryTiles.resize(nTiles);
+		return;
+	}
+
+	// Create the file with the size of all the tiles. The tiles are filled with the initial color when they are used.
+	string fullPath = ofToDataPath(path, true);
+	uint64_t fileSize = uint64_t(nTiles) * tileStride;
+
+#ifdef TARGET_WIN32
+	HANDLE file = CreateFileA(fullPath.c_str(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, CREATE_ALWAYS,
+			FILE_ATTRIBUTE_NORMAL, nullptr);
+
+	if (file == INVALID_HANDLE_VALUE) {
+		close();
+		throw runtime_error("The file " + fullPath + " could not be created.");
+	}
+
+	fileHandle = file;
+	mappingHandle = CreateFileMappingA(file, nullptr, PAGE_READWRITE, DWORD(fileSize >> 32), DWORD(fileSize),
+			nullptr);
+
+	if (mappingHandle == nullptr) {
+		close();
+		throw runtime_error("The file " + fullPath + " could not be resized to " + ofToString(fileSize) + " bytes.");
+	}
+#else
+	fileDescriptor = ::open(fullPath.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+
+	if (fileDescriptor < 0) {
+		close();
+		throw runtime_error("The file " + fullPath + " could not be created.");
+	} else if (ftruncate(fileDescriptor, fileSize) != 0) {
+		close();
+		throw runtime_error("The file " + fullPath + " could not be resized to " + ofToString(fileSize) + " bytes.");
+	}
+#endif
+}
+
+void ofxOilTiledPixels::close() {
+	lock_guard<mutex> lock(tilesMutex);
+
+	// Unmap all the tiles stored in the file
+	if (!path.empty()) {
+		while (!residentTiles.empty()) {
+			unmapTile(residentTiles.back());
+		}
+	}
+
+#ifdef TARGET_WIN32
+	if (mappingHandle != nullptr) {
+		CloseHandle(mappingHandle);
+		mappingHandle = nullptr;
+	}
+
+	if (fileHandle != nullptr) {
+		CloseHandle(fileHandle);
+		fileHandle = nullptr;
+	}
+#else
+	if (fileDescriptor >= 0) {
+		::close(fileDescriptor);
+		fileDescriptor = -1;
+	}
+#endif
+
+	width = 0;
+	height = 0;
+	tiles.clear();
+	initializedTiles.clear();
+	residentTiles.clear();
+	residentPositions.clear();
+	memoryTiles.clear();
+}
+
+bool ofxOilTiledPixels::isAllocated() const {
+	return width > 0 && height > 0;
+}
+
+int ofxOilTiledPixels::getWidth() const {
+	return width;
+}
+
+int ofxOilTiledPixels::getHeight() const {
+	return height;
+}
+
+size_t ofxOilTiledPixels::getNumChannels() const {
+	return nChannels;
+}
+
+unsigned int ofxOilTiledPixels::getTileSize() const {
+	return tileSize;
+}
+
+unsigned int ofxOilTiledPixels::getNResidentTiles() const {
+	lock_guard<mutex> lock(tilesMutex);
+	return residentTiles.size();
+}
+
+void ofxOilTiledPixels::getRegion(int x, int y, int regionWidth, int regionHeight, ofPixels& regionPixels) const {
+	if ((int) regionPixels.getWidth() != regionWidth || (int) regionPixels.getHeight() != regionHeight
+			|| regionPixels.getNumChannels() != nChannels) {
+		regionPixels.allocate(regionWidth, regionHeight, nChannels);
+	}
+
+	copyRegion(x, y, regionWidth, regionHeight, regionPixels.getData(), false);
+}
+
+void ofxOilTiledPixels::setRegion(const ofPixels& regionPixels, int x, int y) {
+	// Check that the input makes sense
+	if (regionPixels.getNumChannels() != nChannels) {
+		throw invalid_argument("The region pixels should have the same number of channels as the tiled pixels.");
+	}
+
+	copyRegion(x, y, regionPixels.getWidth(), regionPixels.getHeight(),
+			const_cast<unsigned char*>(regionPixels.getData()), true);
+}
+
+void ofxOilTiledPixels::flush() {
+	lock_guard<mutex> lock(tilesMutex);
+
+	if (path.empty()) {
+		return;
+	}
+
+	for (unsigned int tile : residentTiles) {
+#ifdef TARGET_WIN32
+		FlushViewOfFile(tiles[tile], tileBytes);
+#else
+		msync(tiles[tile], tileBytes, MS_SYNC);
+#endif
+	}
+}
+
+void ofxOilTiledPixels::copyRegion(int x, int y, int regionWidth, int regionHeight, unsigned char* data,
+		bool write) const {
+	// Check that the region is inside the image
+	if (x < 0 || y < 0 || regionWidth < 0 || regionHeight < 0 || x + regionWidth > width
+			|| y + regionHeight > height) {
+		throw invalid_argument("The region should be inside the tiled pixels.");
+	}
+
+	lock_guard<mutex> lock(tilesMutex);
+
+	// Copy the region rows inside each tile, one tile at a time, so the region can be larger than the resident tiles
+	for (int tileY = y / tileSize; tileY * int(tileSize) < y + regionHeight; ++tileY) {
+		for (int tileX = x / tileSize; tileX * int(tileSize) < x + regionWidth; ++tileX) {
+			unsigned char* tileData = getTile(tileX + tileY * nTilesX);
+			int tileXMin = tileX * tileSize;
+			int tileYMin = tileY * tileSize;
+			int xMin = max(x, tileXMin);
+			int xMax = min(x + regionWidth, tileXMin + int(tileSize));
+			int yMax = min(y + regionHeight, tileYMin + int(tileSize));
+			size_t rowBytes = (xMax - xMin) * nChannels;
+
+			for (int row = max(y, tileYMin); row < yMax; ++row) {
+				size_t tileOffset = (row - tileYMin) * size_t(tileSize) + xMin - tileXMin;
+				unsigned char* tilePixel = tileData + tileOffset * nChannels;
+				unsigned char* regionPixel = data + ((row - y) * size_t(regionWidth) + xMin - x) * nChannels;
+
+				if (write) {
+					memcpy(tilePixel, regionPixel, rowBytes);
+				} else {
+					memcpy(regionPixel, tilePixel, rowBytes);
+				}
+			}
+		}
+	}
+}
+
+unsigned char* ofxOilTiledPixels::getTile(unsigned int tile) const {
+	// Move the tile to the front of the resident tiles if it's already in memory
+	if (tiles[tile] != nullptr) {
+		residentTiles.splice(residentTiles.begin(), residentTiles, residentPositions[tile]);
+		return tiles[tile];
+	}
+
+	if (path.empty()) {
+		// Allocate the tile in memory
+		memoryTiles[tile].resize(tileBytes);
+		tiles[tile] = memoryTiles[tile].data();
+	} else {
+		// Unmap the least recently used tile if there is no space for the new one
+		if (residentTiles.size() >= maxResidentTiles) {
+			unmapTile(residentTiles.back());
+		}
+
+		// Map the tile
+		uint64_t offset = uint64_t(tile) * tileStride;
+#ifdef TARGET_WIN32
+		void* mapping = MapViewOfFile(mappingHandle, FILE_MAP_ALL_ACCESS, DWORD(offset >> 32), DWORD(offset),
+				tileBytes);
+
+		if (mapping == nullptr) {
+			throw runtime_error("The tile " + ofToString(tile) + " of the file " + path + " could not be mapped.");
+		}
+#else
+		void* mapping = mmap(nullptr, tileBytes, PROT_READ | PROT_WRITE, MAP_SHARED, fileDescriptor, offset);
+
+		if (mapping == MAP_FAILED) {
+			throw runtime_error("The tile " + ofToString(tile) + " of the file " + path + " could not be mapped.");
+		}
+#endif
+
+		tiles[tile] = static_cast<unsigned char*>(mapping);
+	}
+
+	// Fill the tile with the initial color the first time it's used
+	if (!initializedTiles[tile]) {
+		unsigned char* tileData = tiles[tile];
+
+		for (size_t pixel = 0; pixel < tileBytes; pixel += nChannels) {
+			for (size_t c = 0; c < nChannels; ++c) {
+				tileData[pixel + c] = fillColor[c];
+			}
+		}
+
+		initializedTiles[tile] = true;
+	}
+
+	residentTiles.push_front(tile);
+	residentPositions[tile] = residentTiles.begin();
+	return tiles[tile];
+}
+
+void ofxOilTiledPixels::unmapTile(unsigned int tile) const {
+	// The operating system writes the modified pages to the file
+#ifdef TARGET_WIN32
+	UnmapViewOfFile(tiles[tile]);
+#else
+	munmap(tiles[tile], tileBytes);
+#endif
+
+	residentTiles.erase(residentPositions[tile]);
+	tiles[tile] = nullptr;
+}
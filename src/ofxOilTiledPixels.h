@@ -0,0 +1,257 @@
+#pragma once
+
+#include "ofMain.h"
+
+/**
+ * @brief Class used to store large images divided in square tiles that are loaded in memory only when they are used
+ *
+ * When a file path is given, the tiles are stored one after the other in that file and each tile is memory mapped
+ * when a region that overlaps it is read or written. Only a maximum number of tiles is kept mapped at the same time,
+ * and the least recently used tile is unmapped when a new one is needed, so the image size is limited by the disk
+ * size and not by the memory. Without a file path the tiles are allocated in memory the first time they are used.
+ * The regions can be read and written from several threads at the same time.
+ *
+ * @author Javier Graciá Carpio
+ */
+class ofxOilTiledPixels {
+public:
+
+	/**
+	 * @brief Constructor
+	 */
+	ofxOilTiledPixels();
+
+	/**
+	 * @brief Destructor. Writes the modified tiles to the file and unmaps them.
+	 */
+	~ofxOilTiledPixels();
+
+	/**
+	 * @brief Deleted copy constructor, since the mappings cannot be shared
+	 */
+	ofxOilTiledPixels(const ofxOilTiledPixels&) = delete;
+
+	/**
+	 * @brief Deleted copy assignment operator, since the mappings cannot be shared
+	 */
+	ofxOilTiledPixels& operator=(const ofxOilTiledPixels&) = delete;
+
+	/**
+	 * @brief Allocates the tiled pixels and fills them with a given color, closing the previous ones if necessary
+	 *
+	 * @param _width the image width
+	 * @param _height the image height
+	 * @param _nChannels the number of color channels (1, 3 or 4)
+	 * @param _fillColor the initial color of all the pixels
+	 * @param _path the path of the file where the tiles will be stored. It will be overwritten if it exists. If
+	 * empty, the tiles will be stored in memory.
+	 * @param _tileSize the tile size in pixels
+	 * @param _maxResidentTiles the maximum number of tiles mapped in memory at the same time. It is only used when
+	 * the tiles are stored in a file.
+	 */
+	void allocate(int _width, int _height, size_t _nChannels, const ofColor& _fillColor, const string& _path = "",
+			unsigned int _tileSize = 256, unsigned int _maxResidentTiles = 64);
+
+	/**
+	 * @brief Writes the modified tiles to the file, unmaps them and closes the file
+	 *
+	 * The file is not removed, but it will be overwritten the next time the tiled pixels are allocated with the
+	 * same path.
+	 */
+	void close();
+
+	/**
+	 * @brief Checks if the tiled pixels have been allocated
+	 *
+	 * @return true if the tiled pixels have been allocated
+	 */
+	bool isAllocated() const;
+
+	/**
+	 * @brief Returns the image width
+	 *
+	 * @return the image width
+	 */
+	int getWidth() const;
+
+	/**
+	 * @brief Returns the image height
+	 *
+	 * @return the image height
+	 */
+	int getHeight() const;
+
+	/**
+	 * @brief Returns the number of color channels
+	 *
+	 * @return the number of color channels
+	 */
+	size_t getNumChannels() const;
+
+	/**
+	 * @brief Returns the tile size
+	 *
+	 * @return the tile size in pixels
+	 */
+	unsigned int getTileSize() const;
+
+	/**
+	 * @brief Returns the number of tiles that are currently in memory
+	 *
+	 * @return the number of tiles in memory
+	 */
+	unsigned int getNResidentTiles() const;
+
+	/**
+	 * @brief Copies the pixels inside a rectangular region
+	 *
+	 * @param x the region minimum x coordinate
+	 * @param y the region minimum y coordinate
+	 * @param regionWidth the region width
+	 * @param regionHeight the region height
+	 * @param regionPixels the pixels where the region will be copied. They will be allocated if necessary.
+	 */
+	void getRegion(int x, int y, int regionWidth, int regionHeight, ofPixels& regionPixels) const;
+
+	/**
+	 * @brief Replaces the pixels inside a rectangular region
+	 *
+	 * @param regionPixels the new region pixels. They should have the same number of color channels.
+	 * @param x the region minimum x coordinate
+	 * @param y the region minimum y coordinate
+	 */
+	void setRegion(const ofPixels& regionPixels, int x, int y);
+
+	/**
+	 * @brief Writes the modified tiles to the file without unmapping them
+	 */
+	void flush();
+
+protected:
+
+	/**
+	 * @brief Copies the pixels between a rectangular region and a data buffer
+	 *
+	 * @param x the region minimum x coordinate
+	 * @param y the region minimum y coordinate
+	 * @param regionWidth the region width
+	 * @param regionHeight the region height
+	 * @param data the data buffer, with the region rows one after the other
+	 * @param write if true the buffer is copied into the region, otherwise the region is copied into the buffer
+	 */
+	void copyRegion(int x, int y, int regionWidth, int regionHeight, unsigned char* data, bool write) const;
+
+	/**
+	 * @brief Returns the data of a tile, loading it in memory if necessary
+	 *
+	 * The tiles mutex should be locked before calling this method.
+	 *
+	 * @param tile the tile index
+	 * @return the tile data, with the tile rows one after the other
+	 */
+	unsigned char* getTile(unsigned int tile) const;
+
+	/**
+	 * @brief Unmaps a tile that is stored in the file
+	 *
+	 * @param tile the tile index
+	 */
+	void unmapTile(unsigned int tile) const;
+
+	/**
+	 * @brief The image width
+	 */
+	int width;
+
+	/**
+	 * @brief The image height
+	 */
+	int height;
+
+	/**
+	 * @brief The number of color channels
+	 */
+	size_t nChannels;
+
+	/**
+	 * @brief The initial color of all the pixels
+	 */
+	ofColor fillColor;
+
+	/**
+	 * @brief The path of the file where the tiles are stored. If empty, the tiles are stored in memory.
+	 */
+	string path;
+
+	/**
+	 * @brief The tile size in pixels
+	 */
+	unsigned int tileSize;
+
+	/**
+	 * @brief The maximum number of tiles mapped in memory at the same time
+	 */
+	unsigned int maxResidentTiles;
+
+	/**
+	 * @brief The number of tiles in the horizontal direction
+	 */
+	unsigned int nTilesX;
+
+	/**
+	 * @brief The number of bytes in each tile
+	 */
+	size_t tileBytes;
+
+	/**
+	 * @brief The distance in bytes between two consecutive tiles in the file, a multiple of the mapping granularity
+	 */
+	size_t tileStride;
+
+	/**
+	 * @brief The data of each tile, or nullptr if the tile is not in memory
+	 */
+	mutable vector<unsigned char*> tiles;
+
+	/**
+	 * @brief Indicates which tiles have been filled with the initial color
+	 */
+	mutable vector<bool> initializedTiles;
+
+	/**
+	 * @brief The tiles mapped in memory, starting with the most recently used
+	 */
+	mutable list<unsigned int> residentTiles;
+
+	/**
+	 * @brief The position of each mapped tile in the resident tiles list
+	 */
+	mutable vector<list<unsigned int>::iterator> residentPositions;
+
+	/**
+	 * @brief The tiles data when they are stored in memory
+	 */
+	mutable vector<vector<unsigned char>> memoryTiles;
+
+	/**
+	 * @brief The mutex protecting the tiles
+	 */
+	mutable mutex tilesMutex;
+
+#ifdef TARGET_WIN32
+	/**
+	 * @brief The file handle
+	 */
+	void* fileHandle;
+
+	/**
+	 * @brief The file mapping handle
+	 */
+	void* mappingHandle;
+#else
+	/**
+	 * @brief The file descriptor
+	 */
+	int fileDescriptor;
+#endif
+};
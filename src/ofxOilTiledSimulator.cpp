@@ -0,0 +1,259 @@
+#include "ofxOilTiledSimulator.h"
+#include "ofxOilSimulator.h"
+#include "ofxOilBristle.h"
+#include "ofxOilThreadPool.h"
+#include "ofxOilRandom.h"
+#include "ofxOilConfig.h"
+#include "ofxOilTiledPixels.h"
+#include "ofMain.h"
+
+ofxOilTiledSimulator::ofxOilTiledSimulator(unsigned int _tileSize, unsigned int nThreads, bool _useCanvasBuffer,
+		const ofxOilConfig& _config) :
+		config(make_shared<const ofxOilConfig>(_config)), tileConfig(_config), tileSize(max(_tileSize, 1u)),
+		useCanvasBuffer(_useCanvasBuffer), threadPool(new ofxOilThreadPool(nThreads)) {
+	maxResidentTiles = 64;
+	wholeCanvasNeedsUpdate = true;
+	textureNeedsUpdate = true;
+	averageBrushSize = config->smallerBrushSize;
+	level = 0;
+	phase = 0;
+	levelTileSize = tileSize;
+	levelHaloSize = 0;
+	nTilesX = 0;
+	nTilesY = 0;
+	paintingIsFinised = true;
+	setSeed(0);
+}
+
+const ofxOilConfig& ofxOilTiledSimulator::getConfig() const {
+	return *config;
+}
+
+void ofxOilTiledSimulator::setSeed(uint64_t seed) {
+	random = ofxOilRandom(seed);
+}
+
+uint64_t ofxOilTiledSimulator::getSeed() const {
+	return random.getKey();
+}
+
+void ofxOilTiledSimulator::setStorageDirectory(const string& directory, unsigned int _maxResidentTiles) {
+	storageDirectory = directory;
+	maxResidentTiles = max(_maxResidentTiles, 1u);
+
+	if (!storageDirectory.empty()) {
+		ofDirectory::createDirectory(storageDirectory, true, true);
+	}
+}
+
+void ofxOilTiledSimulator::setImagePixels(const ofPixels& imagePixels, bool clearCanvas) {
+	setImageSize(imagePixels.getWidth(), imagePixels.getHeight(), clearCanvas);
+	setImageRegion(imagePixels, 0, 0);
+}
+
+void ofxOilTiledSimulator::setImageSize(int width, int height, bool clearCanvas) {
+	// Returns the path of a storage file, or an empty path if the pixels should be stored in memory
+	auto getStoragePath = [this](const string& fileName) {
+		return storageDirectory.empty() ? string() : ofFilePath::join(storageDirectory, fileName);
+	};
+
+	// Initialize the image pixels
+	imgPixels.allocate(width, height, 3, ofColor(0), getStoragePath("image.tiles"), 256, maxResidentTiles);
+
+	// Initialize the canvas pixels if necessary
+	if (clearCanvas || width != canvasPixels.getWidth() || height != canvasPixels.getHeight()) {
+		canvasPixels.allocate(width, height, 3, config->backgroundColor, getStoragePath("canvas.tiles"), 256,
+				maxResidentTiles);
+
+		if (useCanvasBuffer) {
+			canvasBufferPixels.allocate(width, height, 3, config->backgroundColor,
+					getStoragePath("canvasBuffer.tiles"), 256, maxResidentTiles);
+		}
+
+		wholeCanvasNeedsUpdate = true;
+		textureNeedsUpdate = true;
+	}
+
+	// Initialize the rest of the simulator variables
+	float initialBrushSize = config->initialBrushSize > 0 ? config->initialBrushSize : max(width, height) / 6.0f;
+	averageBrushSize = max(config->smallerBrushSize, initialBrushSize);
+	level = 0;
+	phase = 0;
+	stats = ofxOilSimulatorStats();
+	paintingIsFinised = false;
+	startBrushSizeLevel();
+}
+
+void ofxOilTiledSimulator::setImageRegion(const ofPixels& regionPixels, int x, int y) {
+	// The image is stored in RGB format
+	if (regionPixels.getNumChannels() == 3) {
+		imgPixels.setRegion(regionPixels, x, y);
+	} else {
+		ofPixels rgbRegionPixels = regionPixels;
+		rgbRegionPixels.setImageType(OF_IMAGE_COLOR);
+		imgPixels.setRegion(rgbRegionPixels, x, y);
+	}
+}
+
+void ofxOilTiledSimulator::update() {
+	// Don't do anything if the painting is finished
+	if (paintingIsFinised) {
+		return;
+	}
+
+	// Get the tiles that belong to the current checkerboard phase
+	vector<unsigned int> phaseTiles;
+
+	for (int tileY = phase / 2; tileY < nTilesY; tileY += 2) {
+		for (int tileX = phase % 2; tileX < nTilesX; tileX += 2) {
+			phaseTiles.push_back(tileX + tileY * nTilesX);
+		}
+	}
+
+	// Paint the tiles in parallel. Their regions don't overlap, so they can write directly on the canvas.
+	vector<ofxOilSimulatorStats> tilesStats(phaseTiles.size());
+	threadPool->parallelFor(phaseTiles.size(), [this, &phaseTiles, &tilesStats](unsigned int i) {
+		paintTile(phaseTiles[i], tilesStats[i]);
+	});
+
+	// Add the tiles statistics in order
+	for (const ofxOilSimulatorStats& tileStats : tilesStats) {
+		stats += tileStats;
+	}
+
+	wholeCanvasNeedsUpdate = true;
+	textureNeedsUpdate = true;
+
+	// Move to the next phase
+	++phase;
+
+	if (phase == 4) {
+		if (averageBrushSize == config->smallerBrushSize) {
+			// Stop the painting
+			paintingIsFinised = true;
+		} else {
+			// Decrease the brush size
+			averageBrushSize = max(config->smallerBrushSize,
+					min(averageBrushSize / config->brushSizeDecrement, averageBrushSize - 2));
+			++level;
+			phase = 0;
+			startBrushSizeLevel();
+		}
+	}
+}
+
+void ofxOilTiledSimulator::startBrushSizeLevel() {
+	// Make the tiles large enough for the halo of two tiles painted at the same time not to overlap
+	levelHaloSize = ceil(getHaloSize(averageBrushSize));
+	levelTileSize = max((int) tileSize, 2 * levelHaloSize);
+	nTilesX = ceil(imgPixels.getWidth() / float(levelTileSize));
+	nTilesY = ceil(imgPixels.getHeight() / float(levelTileSize));
+
+	// The tile simulators paint only with the current average brush size. They use the more strict stop criteria of
+	// the smaller brush size only if this is the last level.
+	tileConfig = *config;
+	tileConfig.initialBrushSize = averageBrushSize;
+	tileConfig.smallerBrushSize = averageBrushSize;
+
+	if (averageBrushSize > config->smallerBrushSize) {
+		tileConfig.maxInvalidTrajectoriesForSmallerSize = config->maxInvalidTrajectories;
+		tileConfig.maxInvalidTracesForSmallerSize = config->maxInvalidTraces;
+	}
+}
+
+void ofxOilTiledSimulator::paintTile(unsigned int tileIndex, ofxOilSimulatorStats& tileStats) {
+	// Calculate the tile core region and the region including the halo
+	int width = imgPixels.getWidth();
+	int height = imgPixels.getHeight();
+	int coreXMin = (tileIndex % nTilesX) * levelTileSize;
+	int coreYMin = (tileIndex / nTilesX) * levelTileSize;
+	int coreXMax = min(coreXMin + levelTileSize, width);
+	int coreYMax = min(coreYMin + levelTileSize, height);
+	int xMin = max(coreXMin - levelHaloSize, 0);
+	int yMin = max(coreYMin - levelHaloSize, 0);
+	int xMax = min(coreXMax + levelHaloSize, width);
+	int yMax = min(coreYMax + levelHaloSize, height);
+
+	// Extract the tile pixels
+	ofPixels tileImgPixels;
+	ofPixels tileCanvasPixels;
+	ofPixels tileCanvasBufferPixels;
+	imgPixels.getRegion(xMin, yMin, xMax - xMin, yMax - yMin, tileImgPixels);
+	canvasPixels.getRegion(xMin, yMin, xMax - xMin, yMax - yMin, tileCanvasPixels);
+
+	if (useCanvasBuffer) {
+		canvasBufferPixels.getRegion(xMin, yMin, xMax - xMin, yMax - yMin, tileCanvasBufferPixels);
+	}
+
+	// Paint the tile with its own random number stream, starting the traces only inside the tile core
+	ofxOilSimulator simulator(useCanvasBuffer, false, OFX_OIL_CANVAS_PIXELS, tileConfig);
+	simulator.setSeed(random.derive(level).derive(tileIndex).getKey());
+	simulator.setImagePixels(tileImgPixels, true);
+	simulator.setCanvasPixels(tileCanvasPixels, tileCanvasBufferPixels);
+	simulator.setSeedRegion(ofRectangle(coreXMin - xMin, coreYMin - yMin, coreXMax - coreXMin, coreYMax - coreYMin));
+
+	while (!simulator.isFinished()) {
+		simulator.update(false);
+	}
+
+	// Copy the painted tile back into the canvas
+	canvasPixels.setRegion(simulator.getCanvasPixels(), xMin, yMin);
+
+	if (useCanvasBuffer) {
+		canvasBufferPixels.setRegion(simulator.getCanvasBufferPixels(), xMin, yMin);
+	}
+
+	tileStats = simulator.getStats();
+}
+
+void ofxOilTiledSimulator::drawCanvas(float x, float y) const {
+	if (textureNeedsUpdate) {
+		texture.loadData(getCanvasPixels());
+		textureNeedsUpdate = false;
+	}
+
+	texture.draw(x, y);
+}
+
+const ofPixels& ofxOilTiledSimulator::getCanvasPixels() const {
+	if (wholeCanvasNeedsUpdate) {
+		canvasPixels.getRegion(0, 0, canvasPixels.getWidth(), canvasPixels.getHeight(), wholeCanvasPixels);
+		wholeCanvasNeedsUpdate = false;
+	}
+
+	return wholeCanvasPixels;
+}
+
+void ofxOilTiledSimulator::getCanvasRegion(int x, int y, int width, int height, ofPixels& regionPixels) const {
+	canvasPixels.getRegion(x, y, width, height, regionPixels);
+}
+
+float ofxOilTiledSimulator::getHaloSize(float brushSize) const {
+	// Maximum brush size and trace length that the simulator can use with this average brush size
+	float maxBrushSize = max(config->smallerBrushSize, 1.05f * brushSize);
+	float maxTraceLength = max(config->minTraceLength, 1.1f * config->relativeTraceLength * maxBrushSize);
+
+	// Maximum distance between the brush center and the painted pixels
+	float bristlesLength = min(maxBrushSize, config->maxBristleLength);
+	float bristlesThickness = min(0.8f * bristlesLength, config->maxBristleThickness);
+	float bristlesOffset = 0.5 * (maxBrushSize + config->maxBristleHorizontalNoise + config->bristleVerticalNoise);
+	float bristlesReach = ofxOilBristle(glm::vec2(), bristlesLength).getLength() + 0.5 * bristlesThickness + 1;
+
+	return maxTraceLength + bristlesOffset + bristlesReach + 1;
+}
+
+float ofxOilTiledSimulator::getAverageBrushSize() const {
+	return averageBrushSize;
+}
+
+unsigned int ofxOilTiledSimulator::getNTraces() const {
+	return stats.accepted;
+}
+
+const ofxOilSimulatorStats& ofxOilTiledSimulator::getStats() const {
+	return stats;
+}
+
+bool ofxOilTiledSimulator::isFinished() const {
+	return paintingIsFinised;
+}
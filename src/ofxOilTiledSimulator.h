@@ -0,0 +1,305 @@
+#pragma once
+
+#include "ofMain.h"
+#include "ofxOilSimulator.h"
+#include "ofxOilThreadPool.h"
+#include "ofxOilRandom.h"
+#include "ofxOilConfig.h"
+#include "ofxOilSimulatorStats.h"
+#include "ofxOilTiledPixels.h"
+
+/**
+ * @brief Class used to simulate an oil paint on a large canvas using several threads
+ *
+ * The canvas is divided in square tiles. Each tile is painted by its own simulator on the CPU, with traces that start
+ * inside the tile and extend into a halo margin around it. The halo is large enough to contain any trace painted with
+ * the current average brush size, so tiles that are not adjacent can be painted at the same time without interfering.
+ * The tiles are painted in four checkerboard phases for each brush size, and the canvas is synchronized between
+ * phases. The painting obtained for a given seed and image doesn't depend on the number of threads.
+ *
+ * The image and the canvas are stored in tiled pixels, and each tile simulator only copies the region it paints. If a
+ * storage directory is set, they are stored in memory mapped files and only the recently used storage tiles are kept
+ * in memory, so the canvas size is limited by the disk size and not by the memory.
+ *
+ * @author Javier Graciá Carpio
+ */
+class ofxOilTiledSimulator {
+public:
+
+	/**
+	 * @brief Constructor
+	 *
+	 * @param _tileSize the minimum tile size in pixels. The tiles are made larger when the brush size requires it.
+	 * @param nThreads the number of threads used to paint the tiles. If zero, the number of hardware threads will be
+	 * used.
+	 * @param _useCanvasBuffer sets if the simulator should use a canvas buffer for the color mixing calculation
+	 * @param _config the simulation parameters. The simulator keeps its own copy, which cannot be modified.
+	 */
+	ofxOilTiledSimulator(unsigned int _tileSize = 256, unsigned int nThreads = 0, bool _useCanvasBuffer = true,
+			const ofxOilConfig& _config = ofxOilConfig());
+
+	/**
+	 * @brief Returns the simulation parameters
+	 *
+	 * @return the simulation parameters
+	 */
+	const ofxOilConfig& getConfig() const;
+
+	/**
+	 * @brief Sets the seed of the simulator random number stream
+	 *
+	 * @param seed the random number stream seed
+	 */
+	void setSeed(uint64_t seed);
+
+	/**
+	 * @brief Returns the seed of the simulator random number stream
+	 *
+	 * @return the random number stream seed
+	 */
+	uint64_t getSeed() const;
+
+	/**
+	 * @brief Sets the directory where the image and the canvas will be stored the next time the image is set
+	 *
+	 * The files in the directory are overwritten, so two simulators should not share the same directory.
+	 *
+	 * @param directory the storage directory. If empty, the image and the canvas will be stored in memory.
+	 * @param _maxResidentTiles the maximum number of storage tiles of each file kept in memory at the same time
+	 */
+	void setStorageDirectory(const string& directory, unsigned int _maxResidentTiles = 64);
+
+	/**
+	 * @brief Sets the pixels of the image that should be painted
+	 *
+	 * @param imagePixels the pixels of the image that should be painted
+	 * @param clearCanvas if true the canvas will be cleared before the painting starts
+	 */
+	void setImagePixels(const ofPixels& imagePixels, bool clearCanvas);
+
+	/**
+	 * @brief Sets the size of the image that should be painted, so it can be set one region at a time
+	 *
+	 * The image pixels should be set with the setImageRegion method before the next update.
+	 *
+	 * @param width the image width
+	 * @param height the image height
+	 * @param clearCanvas if true the canvas will be cleared before the painting starts
+	 */
+	void setImageSize(int width, int height, bool clearCanvas);
+
+	/**
+	 * @brief Sets the pixels of a region of the image that should be painted
+	 *
+	 * @param regionPixels the region pixels
+	 * @param x the region minimum x coordinate
+	 * @param y the region minimum y coordinate
+	 */
+	void setImageRegion(const ofPixels& regionPixels, int x, int y);
+
+	/**
+	 * @brief Updates the simulation, painting in parallel all the tiles of the current checkerboard phase
+	 */
+	void update();
+
+	/**
+	 * @brief Draws the canvas on the screen
+	 *
+	 * Note that the whole canvas is loaded in memory, so it should only be used with canvases that fit in a texture.
+	 *
+	 * @param x the screen x position
+	 * @param y the screen y position
+	 */
+	void drawCanvas(float x, float y) const;
+
+	/**
+	 * @brief Returns the canvas pixels
+	 *
+	 * Note that the whole canvas is loaded in memory. Use getCanvasRegion with canvases that don't fit in memory.
+	 *
+	 * @return the canvas pixels
+	 */
+	const ofPixels& getCanvasPixels() const;
+
+	/**
+	 * @brief Copies the canvas pixels inside a rectangular region
+	 *
+	 * @param x the region minimum x coordinate
+	 * @param y the region minimum y coordinate
+	 * @param width the region width
+	 * @param height the region height
+	 * @param regionPixels the pixels where the region will be copied
+	 */
+	void getCanvasRegion(int x, int y, int width, int height, ofPixels& regionPixels) const;
+
+	/**
+	 * @brief Returns the halo size needed to contain any trace painted with a given average brush size
+	 *
+	 * @param brushSize the average brush size
+	 * @return the halo size in pixels
+	 */
+	float getHaloSize(float brushSize) const;
+
+	/**
+	 * @brief Returns the current average brush size
+	 *
+	 * @return the current average brush size
+	 */
+	float getAverageBrushSize() const;
+
+	/**
+	 * @brief Returns the total number of painted traces
+	 *
+	 * @return the total number of painted traces
+	 */
+	unsigned int getNTraces() const;
+
+	/**
+	 * @brief Returns the timing and candidate rejection statistics of all the tile simulators
+	 *
+	 * @return the statistics accumulated since the image was set
+	 */
+	const ofxOilSimulatorStats& getStats() const;
+
+	/**
+	 * @brief Indicates if the simulator finished the painting
+	 *
+	 * @return true if the painting is finished
+	 */
+	bool isFinished() const;
+
+protected:
+
+	/**
+	 * @brief Prepares the tiles and the tile simulation parameters for the current average brush size
+	 */
+	void startBrushSizeLevel();
+
+	/**
+	 * @brief Paints one tile until no more traces can be painted on it with the current average brush size
+	 *
+	 * @param tileIndex the tile index
+	 * @param tileStats the statistics where the tile simulator statistics will be saved
+	 */
+	void paintTile(unsigned int tileIndex, ofxOilSimulatorStats& tileStats);
+
+	/**
+	 * @brief The simulation parameters
+	 */
+	shared_ptr<const ofxOilConfig> config;
+
+	/**
+	 * @brief The simulation parameters used by the tile simulators with the current average brush size
+	 */
+	ofxOilConfig tileConfig;
+
+	/**
+	 * @brief The minimum tile size
+	 */
+	unsigned int tileSize;
+
+	/**
+	 * @brief Sets if a canvas buffer should be used for the color mixing calculation
+	 */
+	bool useCanvasBuffer;
+
+	/**
+	 * @brief The simulator random number stream
+	 */
+	ofxOilRandom random;
+
+	/**
+	 * @brief The thread pool used to paint the tiles in parallel
+	 */
+	unique_ptr<ofxOilThreadPool> threadPool;
+
+	/**
+	 * @brief The directory where the image and the canvas are stored. If empty, they are stored in memory.
+	 */
+	string storageDirectory;
+
+	/**
+	 * @brief The maximum number of storage tiles of each file kept in memory at the same time
+	 */
+	unsigned int maxResidentTiles;
+
+	/**
+	 * @brief The pixels of the image to paint
+	 */
+	ofxOilTiledPixels imgPixels;
+
+	/**
+	 * @brief The canvas pixels
+	 */
+	ofxOilTiledPixels canvasPixels;
+
+	/**
+	 * @brief The canvas buffer pixels used for the color mixing calculation
+	 */
+	ofxOilTiledPixels canvasBufferPixels;
+
+	/**
+	 * @brief The whole canvas pixels, used to return and draw the canvas
+	 */
+	mutable ofPixels wholeCanvasPixels;
+
+	/**
+	 * @brief Indicates if the whole canvas pixels should be updated with the canvas pixels
+	 */
+	mutable bool wholeCanvasNeedsUpdate;
+
+	/**
+	 * @brief The texture used to draw the canvas on the screen
+	 */
+	mutable ofTexture texture;
+
+	/**
+	 * @brief Indicates if the texture should be updated with the canvas pixels before drawing it
+	 */
+	mutable bool textureNeedsUpdate;
+
+	/**
+	 * @brief The current average brush size
+	 */
+	float averageBrushSize;
+
+	/**
+	 * @brief The number of brush size levels painted so far
+	 */
+	unsigned int level;
+
+	/**
+	 * @brief The current checkerboard phase
+	 */
+	unsigned int phase;
+
+	/**
+	 * @brief The tile size used with the current average brush size
+	 */
+	int levelTileSize;
+
+	/**
+	 * @brief The halo size used with the current average brush size
+	 */
+	int levelHaloSize;
+
+	/**
+	 * @brief The number of tiles in the horizontal direction
+	 */
+	int nTilesX;
+
+	/**
+	 * @brief The number of tiles in the vertical direction
+	 */
+	int nTilesY;
+
+	/**
+	 * @brief The timing and candidate rejection statistics of all the tile simulators
+	 */
+	ofxOilSimulatorStats stats;
+
+	/**
+	 * @brief Indicates if the painting simulation is finished
+	 */
+	bool paintingIsFinised;
+};
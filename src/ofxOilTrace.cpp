@@ -1,41 +1,39 @@
 #include "ofxOilTrace.h"
 #include "ofxOilBrush.h"
+#include "ofxOilCanvas.h"
+#include "ofxOilRandom.h"
+#include "ofxOilConfig.h"
 #include "ofMain.h"
 
-float ofxOilTrace::NOISE_FACTOR = 0.007;
-
-unsigned char ofxOilTrace::MIN_ALPHA = 20;
-
-float ofxOilTrace::BRIGHTNESS_RELATIVE_CHANGE = 0.09;
-
-unsigned int ofxOilTrace::TYPICAL_MIX_STARTING_STEP = 5;
-
-float ofxOilTrace::MIX_STRENGTH = 0.012;
-
-ofxOilTrace::ofxOilTrace(const glm::vec2& startingPosition, unsigned int nSteps, float speed) {
+ofxOilTrace::ofxOilTrace(const glm::vec2& startingPosition, unsigned int nSteps, float speed,
+		const ofxOilRandom& _random, shared_ptr<const ofxOilConfig> _config) :
+		config(_config), random(_random), brush(glm::vec2(), 5, ofxOilRandom(), _config) {
 	// Check that the input makes sense
 	if (nSteps == 0) {
 		throw invalid_argument("The trace should have at least one step.");
 	}
 
 	// Fill the positions and alphas containers
-	float initAng = ofRandom(TWO_PI);
-	float noiseSeed = ofRandom(1000);
+	float initAng = random.nextFloat(TWO_PI);
+	float noiseSeed = random.nextFloat(1000);
 	float alphaDecrement = min(255.0 / nSteps, 25.0);
 	positions.push_back(startingPosition);
 	alphas.push_back(255);
 
 	for (unsigned int i = 1; i < nSteps; ++i) {
-		float ang = initAng + TWO_PI * (ofNoise(noiseSeed + NOISE_FACTOR * i) - 0.5);
+		float ang = initAng + TWO_PI * (ofNoise(noiseSeed + config->noiseFactor * i) - 0.5);
 		positions.emplace_back(positions[i - 1].x + speed * cos(ang), positions[i - 1].y + speed * sin(ang));
 		alphas.push_back(255 - alphaDecrement * i);
 	}
 
 	// Set the average color as totally transparent
 	averageColor.set(0, 0);
+	colorsNoiseSeed = 0;
 }
 
-ofxOilTrace::ofxOilTrace(const vector<glm::vec2>& _positions, const vector<unsigned char>& _alphas) {
+ofxOilTrace::ofxOilTrace(const vector<glm::vec2>& _positions, const vector<unsigned char>& _alphas,
+		const ofxOilRandom& _random, shared_ptr<const ofxOilConfig> _config) :
+		config(_config), random(_random), brush(glm::vec2(), 5, ofxOilRandom(), _config) {
 	// Check that the input makes sense
 	if (_positions.size() == 0) {
 		throw invalid_argument("The trace should have at least one step.");
@@ -46,16 +44,21 @@ ofxOilTrace::ofxOilTrace(const vector<glm::vec2>& _positions, const vector<unsig
 	positions = _positions;
 	alphas = _alphas;
 	averageColor.set(0, 0);
+	colorsNoiseSeed = 0;
 }
 
 void ofxOilTrace::setBrushSize(float brushSize) {
-	// Initialize the brush
-	brush = ofxOilBrush(positions[0], brushSize);
+	// Initialize the brush with its own random number stream
+	brush = ofxOilBrush(positions[0], brushSize, random.derive(0), config);
+
+	// Set the noise seed used to calculate the bristle colors
+	colorsNoiseSeed = random.nextFloat(1000);
 
 	// Reset the average color
 	averageColor.set(0, 0);
 
 	// Reset the bristle containers
+	bSteps.clear();
 	bPositions.clear();
 	bImgColors.clear();
 	bPaintedColors.clear();
@@ -63,15 +66,23 @@ void ofxOilTrace::setBrushSize(float brushSize) {
 }
 
 void ofxOilTrace::calculateBristlePositions() {
-	// Reset the container
-	bPositions.clear();
+	// Initialize the containers
+	unsigned int nSteps = getNSteps();
+	unsigned int nBristles = getNBristles();
+	bSteps.assign(nSteps, 0);
+	bPositions.resize(nSteps * nBristles);
 
-	for (const glm::vec2& pos : positions) {
+	for (unsigned int i = 0; i < nSteps; ++i) {
 		// Move the brush
-		brush.updatePosition(pos, false);
+		brush.updatePosition(positions[i], false);
 
-		// Save the bristles positions
-		bPositions.push_back(brush.getBristlesPositions());
+		// Save the bristles positions if they have been calculated
+		const vector<glm::vec2>& bp = brush.getBristlesPositions();
+
+		if (bp.size() > 0) {
+			copy(bp.begin(), bp.end(), bPositions.begin() + i * nBristles);
+			bSteps[i] = 1;
+		}
 	}
 
 	// Reset the brush to the initial position
@@ -82,28 +93,36 @@ void ofxOilTrace::calculateBristleImageColors(const ofImage& img) {
 	// Extract some useful information
 	int width = img.getWidth();
 	int height = img.getHeight();
+	unsigned int nBristles = getNBristles();
 
 	// Calculate the bristle positions if necessary
-	if (bPositions.size() == 0) {
+	if (bSteps.size() == 0) {
 		calculateBristlePositions();
 	}
 
 	// Calculate the image colors at the bristles positions
-	bImgColors.clear();
+	bImgColors.resize(bPositions.size());
 
-	for (const vector<glm::vec2>& bp : bPositions) {
-		bImgColors.emplace_back();
-		vector<ofColor>& bic = bImgColors.back();
-
-		for (const glm::vec2& pos : bp) {
-			// Check that the bristle is inside the image
-			int x = pos.x;
-			int y = pos.y;
-
-			if (x >= 0 && x < width && y >= 0 && y < height) {
-				bic.push_back(img.getColor(x, y));
-			} else {
-				bic.emplace_back(0, 0);
+	for (unsigned int i = 0, nSteps = getNSteps(); i < nSteps; ++i) {
+		if (bSteps[i] != 0) {
+			for (unsigned int index = i * nBristles, end = index + nBristles; index < end; ++index) {
+				// Check that the bristle is inside the image
+				const glm::vec2& pos = bPositions[index];
+				int x = pos.x;
+				int y = pos.y;
+
+				if (x >= 0 && x < width && y >= 0 && y < height) {
+					const ofColor& color = img.getColor(x, y);
+					bImgColors.red[index] = color.r;
+					bImgColors.green[index] = color.g;
+					bImgColors.blue[index] = color.b;
+					bImgColors.alpha[index] = color.a;
+				} else {
+					bImgColors.red[index] = 0;
+					bImgColors.green[index] = 0;
+					bImgColors.blue[index] = 0;
+					bImgColors.alpha[index] = 0;
+				}
 			}
 		}
 	}
@@ -113,34 +132,43 @@ void ofxOilTrace::calculateBristlePaintedColors(const ofPixels& paintedPixels, c
 	// Extract some useful information
 	int width = paintedPixels.getWidth();
 	int height = paintedPixels.getHeight();
+	unsigned int nBristles = getNBristles();
 
 	// Calculate the bristle positions if necessary
-	if (bPositions.size() == 0) {
+	if (bSteps.size() == 0) {
 		calculateBristlePositions();
 	}
 
 	// Calculate the painted colors at the bristles positions
-	bPaintedColors.clear();
-
-	for (const vector<glm::vec2>& bp : bPositions) {
-		bPaintedColors.emplace_back();
-		vector<ofColor>& bpc = bPaintedColors.back();
-
-		for (const glm::vec2& pos : bp) {
-			// Check that the bristle is inside the canvas
-			int x = pos.x;
-			int y = pos.y;
+	bPaintedColors.resize(bPositions.size());
 
-			if (x >= 0 && x < width && y >= 0 && y < height) {
-				const ofColor& color = paintedPixels.getColor(x, y);
+	for (unsigned int i = 0, nSteps = getNSteps(); i < nSteps; ++i) {
+		if (bSteps[i] != 0) {
+			for (unsigned int index = i * nBristles, end = index + nBristles; index < end; ++index) {
+				// Check that the bristle is inside the canvas and the pixel has been painted
+				const glm::vec2& pos = bPositions[index];
+				int x = pos.x;
+				int y = pos.y;
+				bool painted = false;
+
+				if (x >= 0 && x < width && y >= 0 && y < height) {
+					const ofColor& color = paintedPixels.getColor(x, y);
+
+					if (color != backgroundColor && color.a != 0) {
+						bPaintedColors.red[index] = color.r;
+						bPaintedColors.green[index] = color.g;
+						bPaintedColors.blue[index] = color.b;
+						bPaintedColors.alpha[index] = color.a;
+						painted = true;
+					}
+				}
 
-				if (color != backgroundColor && color.a != 0) {
-					bpc.push_back(color);
-				} else {
-					bpc.emplace_back(0, 0);
+				if (!painted) {
+					bPaintedColors.red[index] = 0;
+					bPaintedColors.green[index] = 0;
+					bPaintedColors.blue[index] = 0;
+					bPaintedColors.alpha[index] = 0;
 				}
-			} else {
-				bpc.emplace_back(0, 0);
 			}
 		}
 	}
@@ -155,11 +183,12 @@ void ofxOilTrace::setAverageColor(const ofColor& color) {
 
 void ofxOilTrace::calculateAverageColor(const ofImage& img) {
 	// Calculate the bristle image colors if necessary
-	if (bImgColors.size() == 0) {
+	if (bImgColors.empty()) {
 		calculateBristleImageColors(img);
 	}
 
 	// Calculate the trace average color
+	unsigned int nBristles = getNBristles();
 	float redSum = 0;
 	float greenSum = 0;
 	float blueSum = 0;
@@ -167,12 +196,12 @@ void ofxOilTrace::calculateAverageColor(const ofImage& img) {
 
 	for (unsigned int i = 0, nSteps = getNSteps(); i < nSteps; ++i) {
 		// Check that the alpha value is high enough for the average color calculation
-		if (alphas[i] >= MIN_ALPHA) {
-			for (const ofColor& color : bImgColors[i]) {
-				if (color.a != 0) {
-					redSum += color.r;
-					greenSum += color.g;
-					blueSum += color.b;
+		if (alphas[i] >= config->minAlpha && bSteps[i] != 0) {
+			for (unsigned int index = i * nBristles, end = index + nBristles; index < end; ++index) {
+				if (bImgColors.alpha[index] != 0) {
+					redSum += bImgColors.red[index];
+					greenSum += bImgColors.green[index];
+					blueSum += bImgColors.blue[index];
 					++counter;
 				}
 			}
@@ -192,72 +221,97 @@ void ofxOilTrace::calculateBristleColors(const ofPixels& paintedPixels, const of
 	unsigned int nBristles = getNBristles();
 
 	// Calculate the bristle painted colors if necessary
-	if (bPaintedColors.size() == 0) {
+	if (bPaintedColors.empty()) {
 		calculateBristlePaintedColors(paintedPixels, backgroundColor);
 	}
 
 	// Calculate the starting colors for each bristle
-	vector<ofColor> startingColors = vector<ofColor>(nBristles);
-	float noiseSeed = ofRandom(1000);
+	vector<float> redPrevious(nBristles);
+	vector<float> greenPrevious(nBristles);
+	vector<float> bluePrevious(nBristles);
 	float averageHue, averageSaturation, averageBrightness;
 	averageColor.getHsb(averageHue, averageSaturation, averageBrightness);
 
 	for (unsigned int bristle = 0; bristle < nBristles; ++bristle) {
 		// Add some brightness changes to make it more realistic
-		float deltaBrightness = BRIGHTNESS_RELATIVE_CHANGE * averageBrightness
-				* (ofNoise(noiseSeed + 0.4 * bristle) - 0.5);
-		startingColors[bristle].setHsb(averageHue, averageSaturation, averageBrightness + deltaBrightness);
+		float deltaBrightness = config->brightnessRelativeChange * averageBrightness
+				* (ofNoise(colorsNoiseSeed + 0.4 * bristle) - 0.5);
+		ofColor startingColor;
+		startingColor.setHsb(averageHue, averageSaturation, averageBrightness + deltaBrightness);
+		redPrevious[bristle] = startingColor.r;
+		greenPrevious[bristle] = startingColor.g;
+		bluePrevious[bristle] = startingColor.b;
 	}
 
 	// Use the bristle starting colors until the step where the mixing starts
-	unsigned int mixStartingStep = ofClamp(TYPICAL_MIX_STARTING_STEP, 1, nSteps);
-	bColors = vector<vector<ofColor>>(mixStartingStep, startingColors);
-
-	// Mix the previous step colors with the already painted colors
-	vector<float> redPrevious;
-	vector<float> greenPrevious;
-	vector<float> bluePrevious;
-
-	for (const ofColor& color : startingColors) {
-		redPrevious.push_back(color.r);
-		greenPrevious.push_back(color.g);
-		bluePrevious.push_back(color.b);
+	unsigned int mixStartingStep = ofClamp(config->typicalMixStartingStep, 1, nSteps);
+	bColors.resize(nSteps * nBristles);
+	fill(bColors.alpha.begin(), bColors.alpha.end(), 255);
+
+	for (unsigned int i = 0; i < mixStartingStep; ++i) {
+		unsigned int offset = i * nBristles;
+		copy(redPrevious.begin(), redPrevious.end(), bColors.red.begin() + offset);
+		copy(greenPrevious.begin(), greenPrevious.end(), bColors.green.begin() + offset);
+		copy(bluePrevious.begin(), bluePrevious.end(), bColors.blue.begin() + offset);
 	}
 
-	float f = 1 - MIX_STRENGTH;
+	// Mix the previous step colors with the already painted colors
+	float f = 1 - config->mixStrength;
 
 	for (unsigned int i = mixStartingStep; i < nSteps; ++i) {
 		// Copy the previous step colors
-		bColors.push_back(bColors.back());
+		unsigned int offset = i * nBristles;
+		unsigned int previousOffset = offset - nBristles;
+		copy_n(bColors.red.begin() + previousOffset, nBristles, bColors.red.begin() + offset);
+		copy_n(bColors.green.begin() + previousOffset, nBristles, bColors.green.begin() + offset);
+		copy_n(bColors.blue.begin() + previousOffset, nBristles, bColors.blue.begin() + offset);
 
 		// Check that the alpha value is high enough for mixing
-		if (alphas[i] >= MIN_ALPHA) {
+		if (alphas[i] >= config->minAlpha && bSteps[i] != 0) {
 			// Calculate the bristle colors for this step
-			vector<ofColor>& bc = bColors.back();
-			const vector<ofColor>& bpc = bPaintedColors[i];
-
-			if (bpc.size() > 0) {
-				for (unsigned int bristle = 0; bristle < nBristles; ++bristle) {
-					const ofColor& paintedColor = bpc[bristle];
-
-					if (paintedColor.a != 0) {
-						float redMix = f * redPrevious[bristle] + MIX_STRENGTH * paintedColor.r;
-						float greenMix = f * greenPrevious[bristle] + MIX_STRENGTH * paintedColor.g;
-						float blueMix = f * bluePrevious[bristle] + MIX_STRENGTH * paintedColor.b;
-						redPrevious[bristle] = redMix;
-						greenPrevious[bristle] = greenMix;
-						bluePrevious[bristle] = blueMix;
-						bc[bristle].set(redMix, greenMix, blueMix);
-					}
+			const unsigned char* paintedRed = bPaintedColors.red.data() + offset;
+			const unsigned char* paintedGreen = bPaintedColors.green.data() + offset;
+			const unsigned char* paintedBlue = bPaintedColors.blue.data() + offset;
+			const unsigned char* paintedAlpha = bPaintedColors.alpha.data() + offset;
+			unsigned char* red = bColors.red.data() + offset;
+			unsigned char* green = bColors.green.data() + offset;
+			unsigned char* blue = bColors.blue.data() + offset;
+
+			for (unsigned int bristle = 0; bristle < nBristles; ++bristle) {
+				if (paintedAlpha[bristle] != 0) {
+					float redMix = f * redPrevious[bristle] + config->mixStrength * paintedRed[bristle];
+					float greenMix = f * greenPrevious[bristle] + config->mixStrength * paintedGreen[bristle];
+					float blueMix = f * bluePrevious[bristle] + config->mixStrength * paintedBlue[bristle];
+					redPrevious[bristle] = redMix;
+					greenPrevious[bristle] = greenMix;
+					bluePrevious[bristle] = blueMix;
+					red[bristle] = redMix;
+					green[bristle] = greenMix;
+					blue[bristle] = blueMix;
 				}
 			}
 		}
 	}
 }
 
-void ofxOilTrace::paint() {
+void ofxOilTrace::setBristleColors(const ColorPlanes& colors) {
+	// Check that the input makes sense
+	if (colors.red.size() != getNSteps() * getNBristles() || colors.green.size() != colors.red.size()
+			|| colors.blue.size() != colors.red.size()) {
+		throw invalid_argument("There should be one color for each trajectory step and bristle.");
+	}
+
+	bColors = colors;
+
+	// Use opaque colors if the alpha values are not provided
+	if (bColors.alpha.size() != bColors.red.size()) {
+		bColors.alpha.assign(bColors.red.size(), 255);
+	}
+}
+
+void ofxOilTrace::paint(ofxOilCanvas& canvas) {
 	// Check that the bristle colors have been calculated before running this method
-	if (bColors.size() == 0) {
+	if (bColors.empty()) {
 		throw logic_error("Please, run calculateBristleColors method before paint.");
 	}
 
@@ -266,16 +320,16 @@ void ofxOilTrace::paint() {
 		brush.updatePosition(positions[i], true);
 
 		// Paint the brush
-		brush.paint(bColors[i], alphas[i]);
+		brush.paint(canvas, getStepColors(i), alphas[i]);
 	}
 
 	// Reset the brush to the initial position
 	brush.resetPosition(positions[0]);
 }
 
-void ofxOilTrace::paint(ofFbo& canvasBuffer) {
+void ofxOilTrace::paint(ofxOilCanvas& canvas, ofxOilCanvas& canvasBuffer) {
 	// Check that the bristle colors have been calculated before running this method
-	if (bColors.size() == 0) {
+	if (bColors.empty()) {
 		throw logic_error("Please, run calculateBristleColors method before paint.");
 	}
 
@@ -284,12 +338,12 @@ void ofxOilTrace::paint(ofFbo& canvasBuffer) {
 		brush.updatePosition(positions[i], true);
 
 		// Paint the brush
-		brush.paint(bColors[i], alphas[i]);
+		brush.paint(canvas, getStepColors(i), alphas[i]);
 
 		// Paint the trace on the canvas only if alpha is high enough
-		if (alphas[i] >= MIN_ALPHA) {
+		if (alphas[i] >= config->minAlpha) {
 			canvasBuffer.begin();
-			brush.paint(bColors[i], 255);
+			brush.paint(canvasBuffer, stepColors, 255);
 			canvasBuffer.end();
 		}
 	}
@@ -298,9 +352,9 @@ void ofxOilTrace::paint(ofFbo& canvasBuffer) {
 	brush.resetPosition(positions[0]);
 }
 
-void ofxOilTrace::paintStep(unsigned int step) {
+void ofxOilTrace::paintStep(unsigned int step, ofxOilCanvas& canvas) {
 	// Check that the bristle colors have been calculated before running this method
-	if (bColors.size() == 0) {
+	if (bColors.empty()) {
 		throw logic_error("Please, run calculateBristleColors method before paint.");
 	}
 
@@ -310,7 +364,7 @@ void ofxOilTrace::paintStep(unsigned int step) {
 		brush.updatePosition(positions[step], true);
 
 		// Paint the brush
-		brush.paint(bColors[step], alphas[step]);
+		brush.paint(canvas, getStepColors(step), alphas[step]);
 
 		// Reset the brush to the initial position if we are at the last trajectory step
 		if (step == getNSteps() - 1) {
@@ -319,9 +373,9 @@ void ofxOilTrace::paintStep(unsigned int step) {
 	}
 }
 
-void ofxOilTrace::paintStep(unsigned int step, ofFbo& canvasBuffer) {
+void ofxOilTrace::paintStep(unsigned int step, ofxOilCanvas& canvas, ofxOilCanvas& canvasBuffer) {
 	// Check that the bristle colors have been calculated before running this method
-	if (bColors.size() == 0) {
+	if (bColors.empty()) {
 		throw logic_error("Please, run calculateBristleColors method before paint.");
 	}
 
@@ -331,12 +385,12 @@ void ofxOilTrace::paintStep(unsigned int step, ofFbo& canvasBuffer) {
 		brush.updatePosition(positions[step], true);
 
 		// Paint the brush
-		brush.paint(bColors[step], alphas[step]);
+		brush.paint(canvas, getStepColors(step), alphas[step]);
 
 		// Paint the trace on the canvas only if alpha is high enough
-		if (alphas[step] >= MIN_ALPHA) {
+		if (alphas[step] >= config->minAlpha) {
 			canvasBuffer.begin();
-			brush.paint(bColors[step], 255);
+			brush.paint(canvasBuffer, stepColors, 255);
 			canvasBuffer.end();
 		}
 
@@ -367,18 +421,92 @@ unsigned int ofxOilTrace::getNBristles() const {
 	return brush.getNBristles();
 }
 
-const vector<vector<glm::vec2>>& ofxOilTrace::getBristlePositions() const {
+const vector<unsigned char>& ofxOilTrace::getBristleSteps() const {
+	return bSteps;
+}
+
+const vector<glm::vec2>& ofxOilTrace::getBristlePositions() const {
 	return bPositions;
 }
 
-const vector<vector<ofColor>>& ofxOilTrace::getBristleImageColors() const {
+const ofxOilTrace::ColorPlanes& ofxOilTrace::getBristleImageColors() const {
 	return bImgColors;
 }
 
-const vector<vector<ofColor>>& ofxOilTrace::getBristlePaintedColors() const {
+const ofxOilTrace::ColorPlanes& ofxOilTrace::getBristlePaintedColors() const {
 	return bPaintedColors;
 }
 
-const vector<vector<ofColor>>& ofxOilTrace::getBristleColors() const {
+const ofxOilTrace::ColorPlanes& ofxOilTrace::getBristleColors() const {
 	return bColors;
 }
+
+uint64_t ofxOilTrace::getSeed() const {
+	return random.getKey();
+}
+
+float ofxOilTrace::getBrushSize() const {
+	return brush.getSize();
+}
+
+ofRectangle ofxOilTrace::getPaintedRegion() const {
+	// Calculate the bounding box of the bristle positions
+	unsigned int nBristles = getNBristles();
+	float xMin = numeric_limits<float>::max();
+	float yMin = numeric_limits<float>::max();
+	float xMax = numeric_limits<float>::lowest();
+	float yMax = numeric_limits<float>::lowest();
+
+	for (unsigned int i = 0, nSteps = bSteps.size(); i < nSteps; ++i) {
+		if (bSteps[i] != 0) {
+			for (unsigned int index = i * nBristles, end = index + nBristles; index < end; ++index) {
+				const glm::vec2& pos = bPositions[index];
+				xMin = min(xMin, pos.x);
+				yMin = min(yMin, pos.y);
+				xMax = max(xMax, pos.x);
+				yMax = max(yMax, pos.y);
+			}
+		}
+	}
+
+	// Return an empty region if the bristle positions have not been calculated
+	if (xMin > xMax) {
+		return ofRectangle();
+	}
+
+	// Add the brush painting margin
+	float margin = brush.getPaintingMargin();
+
+	return ofRectangle(xMin - margin, yMin - margin, xMax - xMin + 2 * margin, yMax - yMin + 2 * margin);
+}
+
+const vector<ofColor>& ofxOilTrace::getStepColors(unsigned int step) {
+	unsigned int nBristles = getNBristles();
+	unsigned int offset = step * nBristles;
+	stepColors.resize(nBristles);
+
+	for (unsigned int bristle = 0; bristle < nBristles; ++bristle) {
+		stepColors[bristle].set(bColors.red[offset + bristle], bColors.green[offset + bristle],
+				bColors.blue[offset + bristle]);
+	}
+
+	return stepColors;
+}
+
+void ofxOilTrace::ColorPlanes::resize(size_t n) {
+	red.resize(n);
+	green.resize(n);
+	blue.resize(n);
+	alpha.resize(n);
+}
+
+void ofxOilTrace::ColorPlanes::clear() {
+	red.clear();
+	green.clear();
+	blue.clear();
+	alpha.clear();
+}
+
+bool ofxOilTrace::ColorPlanes::empty() const {
+	return red.empty();
+}
@@ -2,6 +2,9 @@
 
 #include "ofMain.h"
 #include "ofxOilBrush.h"
+#include "ofxOilCanvas.h"
+#include "ofxOilRandom.h"
+#include "ofxOilConfig.h"
 
 /**
  * @brief Class that simulates the movement of a brush on the canvas
@@ -12,29 +15,52 @@ class ofxOilTrace {
 public:
 
 	/**
-	 * @brief Sets how random the trace movement is
-	 */
-	static float NOISE_FACTOR;
-
-	/**
-	 * @brief The minimum alpha value to be considered for the trace average color calculation
-	 */
-	static unsigned char MIN_ALPHA;
-
-	/**
-	 * @brief The brightness relative change range between the bristles colors
-	 */
-	static float BRIGHTNESS_RELATIVE_CHANGE;
-
-	/**
-	 * @brief The typical trajectory step when the color mixing starts
-	 */
-	static unsigned int TYPICAL_MIX_STARTING_STEP;
-
-	/**
-	 * @brief The color mixing strength
-	 */
-	static float MIX_STRENGTH;
+	 * @brief Struct containing colors along the trace trajectory stored as separate channel planes
+	 *
+	 * Each plane has one value for each trajectory step and bristle, stored contiguously at the index
+	 * step * nBristles + bristle.
+	 */
+	struct ColorPlanes {
+
+		/**
+		 * @brief Resizes all the channel planes
+		 *
+		 * @param n the new number of values in each plane
+		 */
+		void resize(size_t n);
+
+		/**
+		 * @brief Removes all the values from the channel planes
+		 */
+		void clear();
+
+		/**
+		 * @brief Indicates if the channel planes are empty
+		 *
+		 * @return true if the channel planes are empty
+		 */
+		bool empty() const;
+
+		/**
+		 * @brief The red channel plane
+		 */
+		vector<unsigned char> red;
+
+		/**
+		 * @brief The green channel plane
+		 */
+		vector<unsigned char> green;
+
+		/**
+		 * @brief The blue channel plane
+		 */
+		vector<unsigned char> blue;
+
+		/**
+		 * @brief The alpha channel plane. A zero value indicates that the color is not defined.
+		 */
+		vector<unsigned char> alpha;
+	};
 
 	/**
 	 * @brief Constructor
@@ -42,16 +68,24 @@ public:
 	 * @param startingPosition the trace starting position
 	 * @param nSteps the total number of steps in the trace trajectory
 	 * @param speed the trace moving speed (pixels/step)
+	 * @param _random the random number stream used by the trace and its brush
+	 * @param _config the simulation parameters
 	 */
-	ofxOilTrace(const glm::vec2& startingPosition = glm::vec2(), unsigned int nSteps = 20, float speed = 2);
+	ofxOilTrace(const glm::vec2& startingPosition = glm::vec2(), unsigned int nSteps = 20, float speed = 2,
+			const ofxOilRandom& _random = ofxOilRandom(),
+			shared_ptr<const ofxOilConfig> _config = ofxOilConfig::getDefault());
 
 	/**
 	 * @brief Constructor
 	 *
 	 * @param _positions the trace trajectory positions
 	 * @param _alphas the trace alpha values at each trajectory step
+	 * @param _random the random number stream used by the trace brush
+	 * @param _config the simulation parameters
 	 */
-	ofxOilTrace(const vector<glm::vec2>& _positions, const vector<unsigned char>& _alphas);
+	ofxOilTrace(const vector<glm::vec2>& _positions, const vector<unsigned char>& _alphas,
+			const ofxOilRandom& _random = ofxOilRandom(),
+			shared_ptr<const ofxOilConfig> _config = ofxOilConfig::getDefault());
 
 	/**
 	 * @brief Sets the trace brush size
@@ -82,22 +116,34 @@ public:
 	 */
 	void calculateBristleColors(const ofPixels& paintedPixels, const ofColor& backgroundColor);
 
+	/**
+	 * @brief Sets the trace bristle colors, instead of calculating them
+	 *
+	 * Note that the setBrushSize method should have been run before.
+	 *
+	 * @param colors the bristle colors along the trace trajectory, one for each trajectory step and bristle
+	 */
+	void setBristleColors(const ColorPlanes& colors);
+
 	/**
 	 * @brief Paints the trace
 	 *
 	 * Note that the calculateBristleColors method should have been run before.
+	 *
+	 * @param canvas the canvas where the trace should be painted
 	 */
-	void paint();
+	void paint(ofxOilCanvas& canvas);
 
 	/**
 	 * @brief Paints the trace
 	 *
 	 * Note that the calculateBristleColors method should have been run before.
 	 *
+	 * @param canvas the canvas where the trace should be painted
 	 * @param canvasBuffer the canvas buffer where the trace should also be painted when the color exceeds a minimum
 	 * alpha value
 	 */
-	void paint(ofFbo& canvasBuffer);
+	void paint(ofxOilCanvas& canvas, ofxOilCanvas& canvasBuffer);
 
 	/**
 	 * @brief Paints a given step in the trace trajectory
@@ -105,8 +151,9 @@ public:
 	 * Note that the calculateBristleColors method should have been run before.
 	 *
 	 * @param step the trace trajectory step to paint
+	 * @param canvas the canvas where the trace step should be painted
 	 */
-	void paintStep(unsigned int step);
+	void paintStep(unsigned int step, ofxOilCanvas& canvas);
 
 	/**
 	 * @brief Paints a given step in the trace trajectory
@@ -114,10 +161,11 @@ public:
 	 * Note that the calculateBristleColors method should have been run before.
 	 *
 	 * @param step the trace trajectory step to paint
+	 * @param canvas the canvas where the trace step should be painted
 	 * @param canvasBuffer the canvas buffer where the trace should also be painted when the color exceeds a minimum
 	 * alpha value
 	 */
-	void paintStep(unsigned int step, ofFbo& canvasBuffer);
+	void paintStep(unsigned int step, ofxOilCanvas& canvas, ofxOilCanvas& canvasBuffer);
 
 	/**
 	 * @brief Returns the number of steps in the trace trajectory
@@ -154,33 +202,66 @@ public:
 	 */
 	unsigned int getNBristles() const;
 
+	/**
+	 * @brief Returns which trace trajectory steps have bristle data
+	 *
+	 * The brush needs a few steps to know its direction, so the first steps have no bristle positions and colors.
+	 *
+	 * @return a container with one value for each trajectory step, different from zero if the step has bristle data
+	 */
+	const vector<unsigned char>& getBristleSteps() const;
+
 	/**
 	 * @brief Returns the brush bristle positions along the trace trajectory
 	 *
-	 * @return the brush bristle positions along the trace trajectory
+	 * @return the brush bristle positions along the trace trajectory, stored at the index step * nBristles + bristle
 	 */
-	const vector<vector<glm::vec2>>& getBristlePositions() const;
+	const vector<glm::vec2>& getBristlePositions() const;
 
 	/**
 	 * @brief Returns the brush bristle image colors along the trace trajectory
 	 *
-	 * @return the brush bristle image colors along the trace trajectory
+	 * @return the brush bristle image colors along the trace trajectory. The alpha is zero outside the image.
 	 */
-	const vector<vector<ofColor>>& getBristleImageColors() const;
+	const ColorPlanes& getBristleImageColors() const;
 
 	/**
 	 * @brief Returns the brush bristle painted colors along the trace trajectory
 	 *
-	 * @return the brush bristle painted colors along the trace trajectory
+	 * @return the brush bristle painted colors along the trace trajectory. The alpha is zero for pixels that are
+	 * outside the canvas or have not been painted yet.
 	 */
-	const vector<vector<ofColor>>& getBristlePaintedColors() const;
+	const ColorPlanes& getBristlePaintedColors() const;
 
 	/**
 	 * @brief Returns the brush bristle colors along the trace trajectory
 	 *
 	 * @return the brush bristle colors along the trace trajectory
 	 */
-	const vector<vector<ofColor>>& getBristleColors() const;
+	const ColorPlanes& getBristleColors() const;
+
+	/**
+	 * @brief Returns the seed of the trace random number stream
+	 *
+	 * @return the seed of the trace random number stream
+	 */
+	uint64_t getSeed() const;
+
+	/**
+	 * @brief Returns the trace brush size
+	 *
+	 * @return the trace brush size
+	 */
+	float getBrushSize() const;
+
+	/**
+	 * @brief Returns the region of the canvas that is affected when the trace is painted
+	 *
+	 * Note that the bristle positions should have been calculated before.
+	 *
+	 * @return the rectangle containing all the bristle positions, expanded by the brush painting margin
+	 */
+	ofRectangle getPaintedRegion() const;
 
 protected:
 
@@ -204,6 +285,24 @@ protected:
 	 */
 	void calculateBristlePaintedColors(const ofPixels& paintedPixels, const ofColor& backgroundColor);
 
+	/**
+	 * @brief Returns the bristle colors at a given trajectory step
+	 *
+	 * @param step the trajectory step
+	 * @return the bristle colors at the given step
+	 */
+	const vector<ofColor>& getStepColors(unsigned int step);
+
+	/**
+	 * @brief The simulation parameters
+	 */
+	shared_ptr<const ofxOilConfig> config;
+
+	/**
+	 * @brief The trace random number stream
+	 */
+	ofxOilRandom random;
+
 	/**
 	 * @brief The trace trajectory positions
 	 */
@@ -219,28 +318,43 @@ protected:
 	 */
 	ofColor averageColor;
 
+	/**
+	 * @brief The noise seed used to calculate the bristle colors
+	 */
+	float colorsNoiseSeed;
+
 	/**
 	 * @brief The trace brush
 	 */
 	ofxOilBrush brush;
 
+	/**
+	 * @brief Indicates which trajectory steps have bristle data
+	 */
+	vector<unsigned char> bSteps;
+
 	/**
 	 * @brief The trace bristle positions along the trajectory
 	 */
-	vector<vector<glm::vec2>> bPositions;
+	vector<glm::vec2> bPositions;
 
 	/**
 	 * @brief The trace bristle image colors along the trajectory
 	 */
-	vector<vector<ofColor>> bImgColors;
+	ColorPlanes bImgColors;
 
 	/**
 	 * @brief The trace bristle painted colors along the trajectory
 	 */
-	vector<vector<ofColor>> bPaintedColors;
+	ColorPlanes bPaintedColors;
 
 	/**
 	 * @brief The trace bristle colors along the trajectory
 	 */
-	vector<vector<ofColor>> bColors;
+	ColorPlanes bColors;
+
+	/**
+	 * @brief Container used to pass the bristle colors of one step to the brush
+	 */
+	vector<ofColor> stepColors;
 };
@@ -0,0 +1,94 @@
+#include "ofxOilVarianceMap.h"
+#include "ofMain.h"
+
+ofxOilVarianceMap::ofxOilVarianceMap() :
+		radius(-1) {
+}
+
+void ofxOilVarianceMap::calculate(const ofPixels& pixels, int _radius) {
+	// Check that the input makes sense
+	if (pixels.getNumChannels() < 3) {
+		throw invalid_argument("The variance map needs pixels with at least three color channels.");
+	}
+
+	int width = pixels.getWidth();
+	int height = pixels.getHeight();
+	int nChannels = pixels.getNumChannels();
+	const unsigned char* data = pixels.getData();
+	radius = max(_radius, 0);
+	stdevs.assign(size_t(width) * height, 0);
+
+	// The color sums and squared color sums of each column inside the box rows, and their cumulative sums
+	vector<uint64_t> columnSums(6 * width, 0);
+	vector<uint64_t> cumulativeSums(6 * (width + 1), 0);
+	auto addRow = [&columnSums, data, width, nChannels](int y, bool add) {
+		const unsigned char* row = data + size_t(y) * width * nChannels;
+
+		for (int x = 0; x < width; ++x) {
+			for (int c = 0; c < 3; ++c) {
+				uint64_t value = row[x * nChannels + c];
+				uint64_t& sum = columnSums[6 * x + 2 * c];
+				uint64_t& sqSum = columnSums[6 * x + 2 * c + 1];
+				sum = add ? sum + value : sum - value;
+				sqSum = add ? sqSum + value * value : sqSum - value * value;
+			}
+		}
+	};
+
+	int nextRow = 0;
+
+	for (int y = 0; y < height; ++y) {
+		// Move the box rows window
+		int yMin = max(y - radius, 0);
+		int yMax = min(y + radius + 1, height);
+
+		for (; nextRow < yMax; ++nextRow) {
+			addRow(nextRow, true);
+		}
+
+		if (y - radius - 1 >= 0) {
+			addRow(y - radius - 1, false);
+		}
+
+		// Calculate the cumulative column sums
+		for (int x = 0; x < width; ++x) {
+			for (int i = 0; i < 6; ++i) {
+				cumulativeSums[6 * (x + 1) + i] = cumulativeSums[6 * x + i] + columnSums[6 * x + i];
+			}
+		}
+
+		// Calculate the color variances inside the box centered on each pixel
+		for (int x = 0; x < width; ++x) {
+			int xMin = max(x - radius, 0);
+			int xMax = min(x + radius + 1, width);
+			double nPixels = double(yMax - yMin) * (xMax - xMin);
+			double maxVariance = 0;
+
+			for (int c = 0; c < 3; ++c) {
+				double sum = cumulativeSums[6 * xMax + 2 * c] - cumulativeSums[6 * xMin + 2 * c];
+				double sqSum = cumulativeSums[6 * xMax + 2 * c + 1] - cumulativeSums[6 * xMin + 2 * c + 1];
+				double mean = sum / nPixels;
+				maxVariance = max(maxVariance, sqSum / nPixels - mean * mean);
+			}
+
+			stdevs[size_t(y) * width + x] = min(sqrt(maxVariance), 255.0);
+		}
+	}
+}
+
+void ofxOilVarianceMap::clear() {
+	radius = -1;
+	stdevs.clear();
+}
+
+bool ofxOilVarianceMap::isCalculated() const {
+	return radius >= 0;
+}
+
+int ofxOilVarianceMap::getRadius() const {
+	return radius;
+}
+
+unsigned char ofxOilVarianceMap::getStdev(unsigned int pixel) const {
+	return stdevs[pixel];
+}
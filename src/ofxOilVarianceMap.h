@@ -0,0 +1,68 @@
+#pragma once
+
+#include "ofMain.h"
+
+/**
+ * @brief Class used to calculate the local color standard deviation around each image pixel
+ *
+ * The color variance of each color channel is calculated in a square box centered on every pixel, using running box
+ * sums along the image rows and columns, so the cost is independent of the box size. The simulator uses it to measure
+ * the image flatness at the brush scale.
+ *
+ * @author Javier Graciá Carpio
+ */
+class ofxOilVarianceMap {
+public:
+
+	/**
+	 * @brief Constructor
+	 */
+	ofxOilVarianceMap();
+
+	/**
+	 * @brief Calculates the largest color channel standard deviation in the box centered on each pixel
+	 *
+	 * @param pixels the image pixels. Only the first three color channels are used.
+	 * @param _radius the box radius in pixels. The box side is 2 * radius + 1, clipped at the image borders.
+	 */
+	void calculate(const ofPixels& pixels, int _radius);
+
+	/**
+	 * @brief Removes the calculated map
+	 */
+	void clear();
+
+	/**
+	 * @brief Checks if the map has been calculated
+	 *
+	 * @return true if the map has been calculated
+	 */
+	bool isCalculated() const;
+
+	/**
+	 * @brief Returns the box radius used to calculate the map
+	 *
+	 * @return the box radius in pixels. It is negative if the map has not been calculated.
+	 */
+	int getRadius() const;
+
+	/**
+	 * @brief Returns the color standard deviation around a pixel
+	 *
+	 * @param pixel the pixel index (y * width + x)
+	 * @return the largest color channel standard deviation in the box centered on the pixel, rounded down
+	 */
+	unsigned char getStdev(unsigned int pixel) const;
+
+protected:
+
+	/**
+	 * @brief The box radius used to calculate the map
+	 */
+	int radius;
+
+	/**
+	 * @brief The largest color channel standard deviation around each pixel, limited to 255
+	 */
+	vector<unsigned char> stdevs;
+};
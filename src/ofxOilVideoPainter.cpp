@@ -0,0 +1,175 @@
+#include "ofxOilVideoPainter.h"
+#include "ofxOilSimulator.h"
+#include "ofxOilConfig.h"
+#include "ofMain.h"
+
+ofxOilVideoPainter::ofxOilVideoPainter(unsigned int _bufferSize, bool _useCanvasBuffer, bool _repaintOnlyChanges,
+		const ofxOilConfig& _config) :
+		useCanvasBuffer(_useCanvasBuffer), repaintOnlyChanges(_repaintOnlyChanges), config(_config),
+		decodedFrames(_bufferSize), resizedFrames(_bufferSize), paintedFrames(_bufferSize) {
+	width = 0;
+	height = 0;
+	stopRequested = false;
+
+	// There is nothing to paint until the pipeline is started
+	paintedFrames.close();
+}
+
+ofxOilVideoPainter::~ofxOilVideoPainter() {
+	stop();
+}
+
+void ofxOilVideoPainter::start(const string& videoPath, float sizeReductionFactor) {
+	// Stop the previous video, since the decoding thread could be using the video player
+	stop();
+
+	// Load the video. The frames pixels are only needed on the CPU.
+	video.setUseTexture(false);
+
+	if (!video.load(videoPath)) {
+		throw runtime_error("The video file " + videoPath + " could not be loaded.");
+	}
+
+	video.setLoopState(OF_LOOP_NONE);
+	video.play();
+	video.setPaused(true);
+	video.setFrame(0);
+
+	// Decode the frames sequentially, without seeking
+	unsigned int nextFrame = 0;
+	auto frameSource = [this, nextFrame](ofPixels& pixels) mutable {
+		if (nextFrame >= (unsigned int) video.getTotalNumFrames()) {
+			return false;
+		}
+
+		if (nextFrame > 0) {
+			video.nextFrame();
+		}
+
+		video.update();
+		pixels = video.getPixels();
+		++nextFrame;
+		return true;
+	};
+
+	start(frameSource, video.getWidth() / sizeReductionFactor, video.getHeight() / sizeReductionFactor);
+}
+
+void ofxOilVideoPainter::start(const function<bool(ofPixels&)>& frameSource, int _width, int _height) {
+	// Check that the input makes sense
+	if (_width <= 0 || _height <= 0) {
+		throw invalid_argument("The painted frames dimensions should be positive.");
+	}
+
+	// Stop the previous pipeline if it's still running
+	if (decodeThread.joinable()) {
+		stop();
+	}
+
+	width = _width;
+	height = _height;
+
+	// Start the pipeline threads
+	decodedFrames.reset();
+	resizedFrames.reset();
+	paintedFrames.reset();
+	stopRequested = false;
+	decodeThread = thread(&ofxOilVideoPainter::decodeFrames, this, frameSource);
+	resizeThread = thread(&ofxOilVideoPainter::resizeFrames, this);
+	paintThread = thread(&ofxOilVideoPainter::paintFrames, this);
+}
+
+void ofxOilVideoPainter::stop() {
+	// Tell the threads to stop and wake up the ones waiting for the buffers
+	stopRequested = true;
+	decodedFrames.close();
+	resizedFrames.close();
+	paintedFrames.close();
+
+	// Wait until the threads finish
+	for (thread* stageThread : {&decodeThread, &resizeThread, &paintThread}) {
+		if (stageThread->joinable()) {
+			stageThread->join();
+		}
+	}
+}
+
+bool ofxOilVideoPainter::getPaintedFrame(Frame& frame) {
+	return paintedFrames.tryPop(frame);
+}
+
+int ofxOilVideoPainter::getWidth() const {
+	return width;
+}
+
+int ofxOilVideoPainter::getHeight() const {
+	return height;
+}
+
+bool ofxOilVideoPainter::isFinished() const {
+	return paintedFrames.isDrained();
+}
+
+void ofxOilVideoPainter::decodeFrames(function<bool(ofPixels&)> frameSource) {
+	// Decode the frames until there are no more frames or the pipeline is stopped
+	for (unsigned int index = 0; !stopRequested; ++index) {
+		Frame frame;
+		frame.index = index;
+
+		if (!frameSource(frame.pixels) || !decodedFrames.push(move(frame))) {
+			break;
+		}
+	}
+
+	// Tell the next stage that there are no more frames
+	decodedFrames.close();
+}
+
+void ofxOilVideoPainter::resizeFrames() {
+	Frame frame;
+
+	while (!stopRequested && decodedFrames.pop(frame)) {
+		// Resize the frame if necessary and use always the RGB format
+		if ((int) frame.pixels.getWidth() != width || (int) frame.pixels.getHeight() != height) {
+			frame.pixels.resize(width, height);
+		}
+
+		frame.pixels.setImageType(OF_IMAGE_COLOR);
+
+		if (!resizedFrames.push(move(frame))) {
+			break;
+		}
+	}
+
+	// Tell the next stage that there are no more frames
+	resizedFrames.close();
+}
+
+void ofxOilVideoPainter::paintFrames() {
+	// The simulator paints on the CPU, since this is not the OpenGL thread
+	ofxOilSimulator simulator(useCanvasBuffer, false, OFX_OIL_CANVAS_PIXELS, config);
+	Frame frame;
+
+	while (!stopRequested && resizedFrames.pop(frame)) {
+		// Paint the frame
+		if (repaintOnlyChanges) {
+			simulator.setVideoFramePixels(frame.pixels);
+		} else {
+			simulator.setImagePixels(frame.pixels, true);
+		}
+
+		while (!simulator.isFinished() && !stopRequested) {
+			simulator.update(false);
+		}
+
+		// Save the painted canvas
+		frame.canvasPixels = simulator.getCanvasPixels();
+
+		if (stopRequested || !paintedFrames.push(move(frame))) {
+			break;
+		}
+	}
+
+	// Tell the calling thread that there are no more frames
+	paintedFrames.close();
+}
@@ -0,0 +1,195 @@
+#pragma once
+
+#include "ofMain.h"
+#include "ofxOilSimulator.h"
+#include "ofxOilRingBuffer.h"
+#include "ofxOilConfig.h"
+
+/**
+ * @brief Class used to paint the frames of a video in a pipeline of three threads
+ *
+ * The first thread decodes the video frames sequentially, the second thread resizes them and the third thread paints
+ * them with an oil painting simulator on the CPU. The stages are connected with bounded buffers, so the decoding and
+ * resizing run while the previous frames are painted and the throughput is set by the slowest stage. The painted
+ * frames are obtained from the calling thread, in the same order as they were decoded.
+ *
+ * @author Javier Graciá Carpio
+ */
+class ofxOilVideoPainter {
+public:
+
+	/**
+	 * @brief Struct containing the information of one video frame
+	 */
+	struct Frame {
+		/**
+		 * @brief The frame index in the video
+		 */
+		unsigned int index = 0;
+
+		/**
+		 * @brief The frame pixels
+		 */
+		ofPixels pixels;
+
+		/**
+		 * @brief The canvas pixels after painting the frame
+		 */
+		ofPixels canvasPixels;
+	};
+
+	/**
+	 * @brief Constructor
+	 *
+	 * @param _bufferSize the maximum number of frames waiting between two pipeline stages
+	 * @param _useCanvasBuffer sets if the simulator should use a canvas buffer for the color mixing calculation
+	 * @param _repaintOnlyChanges if true, each frame is painted over the previous painted frame, repainting only the
+	 * regions that changed. Otherwise each frame is painted on a clean canvas.
+	 * @param _config the simulation parameters
+	 */
+	ofxOilVideoPainter(unsigned int _bufferSize = 4, bool _useCanvasBuffer = false, bool _repaintOnlyChanges = true,
+			const ofxOilConfig& _config = ofxOilConfig());
+
+	/**
+	 * @brief Destructor. Stops all the pipeline threads.
+	 */
+	~ofxOilVideoPainter();
+
+	/**
+	 * @brief Loads a video file and starts painting its frames
+	 *
+	 * The video player is only used from the decoding thread after it has been loaded.
+	 *
+	 * @param videoPath the video file path
+	 * @param sizeReductionFactor the size reduction factor between the video frames and the painted frames
+	 */
+	void start(const string& videoPath, float sizeReductionFactor = 1.0);
+
+	/**
+	 * @brief Starts painting the frames obtained from a frame source
+	 *
+	 * @param frameSource the function called from the decoding thread to obtain the next frame pixels. It should
+	 * return false when there are no more frames.
+	 * @param _width the painted frames width
+	 * @param _height the painted frames height
+	 */
+	void start(const function<bool(ofPixels&)>& frameSource, int _width, int _height);
+
+	/**
+	 * @brief Stops all the pipeline threads, discarding the frames that were not painted yet
+	 */
+	void stop();
+
+	/**
+	 * @brief Returns the next painted frame if it's available, without waiting for it
+	 *
+	 * @param frame the frame where the painted frame will be moved
+	 * @return true if a painted frame was available
+	 */
+	bool getPaintedFrame(Frame& frame);
+
+	/**
+	 * @brief Returns the painted frames width
+	 *
+	 * @return the painted frames width
+	 */
+	int getWidth() const;
+
+	/**
+	 * @brief Returns the painted frames height
+	 *
+	 * @return the painted frames height
+	 */
+	int getHeight() const;
+
+	/**
+	 * @brief Indicates if all the frames have been painted and obtained
+	 *
+	 * @return true if all the frames have been painted and obtained
+	 */
+	bool isFinished() const;
+
+protected:
+
+	/**
+	 * @brief The function run by the decoding thread
+	 *
+	 * @param frameSource the function used to obtain the next frame pixels
+	 */
+	void decodeFrames(function<bool(ofPixels&)> frameSource);
+
+	/**
+	 * @brief The function run by the resizing thread
+	 */
+	void resizeFrames();
+
+	/**
+	 * @brief The function run by the painting thread
+	 */
+	void paintFrames();
+
+	/**
+	 * @brief Sets if the simulator should use a canvas buffer for the color mixing calculation
+	 */
+	bool useCanvasBuffer;
+
+	/**
+	 * @brief Sets if only the regions that changed between frames should be repainted
+	 */
+	bool repaintOnlyChanges;
+
+	/**
+	 * @brief The simulation parameters
+	 */
+	ofxOilConfig config;
+
+	/**
+	 * @brief The video player used by the decoding thread
+	 */
+	ofVideoPlayer video;
+
+	/**
+	 * @brief The painted frames width
+	 */
+	int width;
+
+	/**
+	 * @brief The painted frames height
+	 */
+	int height;
+
+	/**
+	 * @brief The frames waiting to be resized
+	 */
+	ofxOilRingBuffer<Frame> decodedFrames;
+
+	/**
+	 * @brief The frames waiting to be painted
+	 */
+	ofxOilRingBuffer<Frame> resizedFrames;
+
+	/**
+	 * @brief The painted frames waiting to be obtained
+	 */
+	ofxOilRingBuffer<Frame> paintedFrames;
+
+	/**
+	 * @brief The decoding thread
+	 */
+	thread decodeThread;
+
+	/**
+	 * @brief The resizing thread
+	 */
+	thread resizeThread;
+
+	/**
+	 * @brief The painting thread
+	 */
+	thread paintThread;
+
+	/**
+	 * @brief Indicates if the pipeline threads should stop
+	 */
+	atomic<bool> stopRequested;
+};
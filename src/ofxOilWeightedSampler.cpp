@@ -0,0 +1,89 @@
+#include "ofxOilWeightedSampler.h"
+#include "ofMain.h"
+
+ofxOilWeightedSampler::ofxOilWeightedSampler() :
+		topBit(0) {
+}
+
+void ofxOilWeightedSampler::reset(unsigned int n) {
+	weights.assign(n, 0);
+	tree.assign(n + 1, 0);
+	topBit = 1;
+
+	while (n > 0 && topBit <= n / 2) {
+		topBit *= 2;
+	}
+}
+
+void ofxOilWeightedSampler::setInitialWeight(unsigned int index, unsigned short weight) {
+	weights[index] = weight;
+}
+
+void ofxOilWeightedSampler::build() {
+	// Add each node to its parent node, so every node is visited only once
+	unsigned int n = weights.size();
+
+	for (unsigned int i = 1; i <= n; ++i) {
+		tree[i] = weights[i - 1];
+	}
+
+	for (unsigned int i = 1; i <= n; ++i) {
+		unsigned int parent = i + (i & -i);
+
+		if (parent <= n) {
+			tree[parent] += tree[i];
+		}
+	}
+}
+
+void ofxOilWeightedSampler::setWeight(unsigned int index, unsigned short weight) {
+	int64_t difference = int64_t(weight) - weights[index];
+
+	if (difference == 0) {
+		return;
+	}
+
+	weights[index] = weight;
+
+	for (unsigned int i = index + 1, n = weights.size(); i <= n; i += i & -i) {
+		tree[i] += difference;
+	}
+}
+
+unsigned short ofxOilWeightedSampler::getWeight(unsigned int index) const {
+	return weights[index];
+}
+
+uint64_t ofxOilWeightedSampler::getTotalWeight() const {
+	// Add the nodes that cover the whole range
+	uint64_t total = 0;
+
+	for (unsigned int i = weights.size(); i > 0; i -= i & -i) {
+		total += tree[i];
+	}
+
+	return total;
+}
+
+unsigned int ofxOilWeightedSampler::find(uint64_t value) const {
+	uint64_t offset;
+	return find(value, offset);
+}
+
+unsigned int ofxOilWeightedSampler::find(uint64_t value, uint64_t& offset) const {
+	// Descend the tree, moving to the right half every time the value is larger than the left half sum
+	unsigned int position = 0;
+	unsigned int n = weights.size();
+
+	for (unsigned int bit = topBit; bit > 0; bit /= 2) {
+		unsigned int next = position + bit;
+
+		if (next <= n && tree[next] <= value) {
+			position = next;
+			value -= tree[next];
+		}
+	}
+
+	offset = value;
+	return min(position, n - 1);
+}
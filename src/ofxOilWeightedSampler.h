@@ -0,0 +1,103 @@
+#pragma once
+
+#include "ofMain.h"
+
+/**
+ * @brief Class used to draw indices with a probability proportional to their weights
+ *
+ * The weights are stored in a Fenwick tree (binary indexed tree), so changing one weight and drawing one index both
+ * cost O(log n). The simulator uses it to draw the trace starting pixels in proportion to their color error, updating
+ * only the weights of the pixels covered by the last painted trace.
+ *
+ * @author Javier Graciá Carpio
+ */
+class ofxOilWeightedSampler {
+public:
+
+	/**
+	 * @brief Constructor
+	 */
+	ofxOilWeightedSampler();
+
+	/**
+	 * @brief Sets the number of indices and sets all their weights to zero
+	 *
+	 * @param n the number of indices
+	 */
+	void reset(unsigned int n);
+
+	/**
+	 * @brief Sets the weight of an index without updating the tree
+	 *
+	 * It can be run in parallel for different indices. The build method should be run after all the weights are set.
+	 *
+	 * @param index the index
+	 * @param weight the index weight
+	 */
+	void setInitialWeight(unsigned int index, unsigned short weight);
+
+	/**
+	 * @brief Builds the tree from the weights set with setInitialWeight in O(n)
+	 */
+	void build();
+
+	/**
+	 * @brief Changes the weight of an index, updating the tree in O(log n)
+	 *
+	 * @param index the index
+	 * @param weight the new index weight
+	 */
+	void setWeight(unsigned int index, unsigned short weight);
+
+	/**
+	 * @brief Returns the weight of an index
+	 *
+	 * @param index the index
+	 * @return the index weight
+	 */
+	unsigned short getWeight(unsigned int index) const;
+
+	/**
+	 * @brief Returns the sum of all the weights
+	 *
+	 * @return the sum of all the weights
+	 */
+	uint64_t getTotalWeight() const;
+
+	/**
+	 * @brief Returns the index where the cumulative weight exceeds a given value
+	 *
+	 * Drawing the value uniformly in [0, total weight) draws the index with a probability proportional to its weight.
+	 *
+	 * @param value the cumulative weight value. It should be smaller than the total weight.
+	 * @return the first index whose cumulative weight (including its own weight) is larger than the value
+	 */
+	unsigned int find(uint64_t value) const;
+
+	/**
+	 * @brief Returns the index where the cumulative weight exceeds a given value, and the value offset inside the
+	 * index weight
+	 *
+	 * @param value the cumulative weight value. It should be smaller than the total weight.
+	 * @param offset the value minus the cumulative weight of the previous indices
+	 * @return the first index whose cumulative weight (including its own weight) is larger than the value
+	 */
+	unsigned int find(uint64_t value, uint64_t& offset) const;
+
+protected:
+
+	/**
+	 * @brief The index weights
+	 */
+	vector<unsigned short> weights;
+
+	/**
+	 * @brief The Fenwick tree partial sums. Element i contains the sum of the weights in (i - lowbit(i), i].
+	 */
+	vector<uint64_t> tree;
+
+	/**
+	 * @brief The largest power of two that is not larger than the number of indices
+	 */
+	unsigned int topBit;
+};